@@ -37,13 +37,17 @@ using namespace vixl::aarch64;
 // This program measures code generation time using the MacroAssembler. It aims
 // to be representative of realistic usage, but is not based on real traces.
 int main(int argc, char* argv[]) {
-  BenchCLI cli(argc, argv);
+  BenchCLI cli(argc,
+               argv,
+               "--bulk-emission",
+               "Emit straight-line sequences in a BulkEmissionScope.");
   if (cli.ShouldExitEarly()) return cli.GetExitCode();
 
   const size_t buffer_size = 256 * KBytes;
   MacroAssembler masm(buffer_size);
   masm.SetCPUFeatures(CPUFeatures::All());
   BenchCodeGenerator generator(&masm);
+  generator.EnableBulkEmission(cli.IsOptionSet());
 
   BenchTimer timer;
 
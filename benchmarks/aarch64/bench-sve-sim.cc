@@ -0,0 +1,124 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "globals-vixl.h"
+
+#include "aarch64/instructions-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#include "bench-utils.h"
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+
+using namespace vixl;
+using namespace vixl::aarch64;
+
+static const int kLoopCount = 1000;
+static const int kRegisterPairs = 8;
+
+// Generate a loop of unpredicated integer add, sub and bitwise operations, on
+// either SVE or NEON registers. Both forms execute the same number of
+// instructions.
+static void Generate(MacroAssembler* masm, bool neon) {
+  Label loop;
+  masm->Mov(x0, kLoopCount);
+  masm->Bind(&loop);
+  for (int i = 0; i < kRegisterPairs; i++) {
+    if (neon) {
+      VRegister vd = VRegister(i, kFormat4S);
+      VRegister vm = VRegister(i + kRegisterPairs, kFormat4S);
+      masm->Add(vd, vd, vm);
+      masm->Sub(vd, vd, vm);
+      masm->And(vd.V16B(), vd.V16B(), vm.V16B());
+      masm->Bic(vd.V16B(), vd.V16B(), vm.V16B());
+      masm->Eor(vd.V16B(), vd.V16B(), vm.V16B());
+      masm->Orr(vd.V16B(), vd.V16B(), vm.V16B());
+    } else {
+      ZRegister zd = ZRegister(i, kSRegSize);
+      ZRegister zm = ZRegister(i + kRegisterPairs, kSRegSize);
+      masm->Add(zd, zd, zm);
+      masm->Sub(zd, zd, zm);
+      masm->And(zd.VnD(), zd.VnD(), zm.VnD());
+      masm->Bic(zd.VnD(), zd.VnD(), zm.VnD());
+      masm->Eor(zd.VnD(), zd.VnD(), zm.VnD());
+      masm->Orr(zd.VnD(), zd.VnD(), zm.VnD());
+    }
+  }
+  masm->Subs(x0, x0, 1);
+  masm->B(ne, &loop);
+  masm->Ret();
+}
+
+// This program measures the simulation of simple SVE lane-wise operations, for
+// several vector lengths, or of the equivalent NEON code.
+int main(int argc, char* argv[]) {
+  BenchCLI cli(argc,
+               argv,
+               "--neon",
+               "Simulate the equivalent NEON code instead of SVE.");
+  if (cli.ShouldExitEarly()) return cli.GetExitCode();
+  bool neon = cli.IsOptionSet();
+
+  MacroAssembler masm;
+  masm.SetCPUFeatures(CPUFeatures::All());
+  Generate(&masm, neon);
+  masm.FinalizeCode();
+
+  const Instruction* start =
+      masm.GetBuffer()->GetStartAddress<const Instruction*>();
+
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.SetCPUFeatures(CPUFeatures::All());
+
+  // The simulator handles all vector lengths with the same code.
+  static const unsigned kVectorLengths[] = {128, 256, 384, 512, 2048};
+  size_t runs = neon ? 1 : ArrayLength(kVectorLengths);
+  for (size_t i = 0; i < runs; i++) {
+    if (!neon) {
+      simulator.SetVectorLengthInBits(kVectorLengths[i]);
+      printf("VL %u: ", kVectorLengths[i]);
+    }
+
+    BenchTimer timer;
+    size_t iterations = 0;
+    do {
+      simulator.RunFrom(start);
+      iterations++;
+    } while (!timer.HasRunFor(cli.GetRunTimeInSeconds()));
+
+    cli.PrintResults(iterations, timer.GetElapsedSeconds());
+  }
+  return cli.GetExitCode();
+}
+
+#else   // VIXL_INCLUDE_SIMULATOR_AARCH64
+int main(void) {
+  printf("This benchmark requires AArch64 simulator support.\n");
+  return EXIT_FAILURE;
+}
+#endif  // VIXL_INCLUDE_SIMULATOR_AARCH64
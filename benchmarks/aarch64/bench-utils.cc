@@ -156,6 +156,13 @@ void BenchCodeGenerator::GenerateArbitrarySequence() {
     return;
   }
 
+  // The remaining sequences are short and straight-line, so they can each be
+  // emitted with a single emission check.
+  BulkEmissionScope scope;
+  if (bulk_emission_) {
+    scope.Open(masm_, BulkEmissionScope::GetSizeForMacroInstructions(32));
+  }
+
   // These weightings should be roughly representative of real functions.
   switch (GetRandomBits(4)) {
     case 0x0:
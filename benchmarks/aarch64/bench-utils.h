@@ -70,8 +70,19 @@ class BenchTimer {
 class BenchCLI {
  public:
   // Set default values.
-  BenchCLI(int argc, char* argv[])
-      : run_time_(kDefaultRunTime), status_(kRunBenchmark) {
+  //
+  // A benchmark can accept one extra flag, `option`, to select a variant of
+  // what it measures. `option_help` describes it in the usage message.
+  BenchCLI(int argc,
+           char* argv[],
+           const char* option = NULL,
+           const char* option_help = NULL)
+      : run_time_(kDefaultRunTime),
+        status_(kRunBenchmark),
+        option_(option),
+        option_help_(option_help),
+        option_set_(false) {
+    VIXL_ASSERT((option == NULL) == (option_help == NULL));
     for (int i = 1; i < argc; i++) {
       if ((strcmp(argv[i], "-h") == 0) || (strcmp(argv[i], "--help") == 0)) {
         PrintUsage(argv[0]);
@@ -80,18 +91,27 @@ class BenchCLI {
       }
     }
 
-    // Use the default run time.
-    if (argc == 1) return;
-
-    if (argc != 2) {
-      if (argc > 0) PrintUsage(argv[0]);
-      status_ = kExitFailure;
-      return;
+    // Extract the option, if present.
+    int run_time_index = 0;
+    for (int i = 1; i < argc; i++) {
+      if ((option_ != NULL) && (strcmp(argv[i], option_) == 0)) {
+        option_set_ = true;
+      } else if (run_time_index == 0) {
+        run_time_index = i;
+      } else {
+        PrintUsage(argv[0]);
+        status_ = kExitFailure;
+        return;
+      }
     }
 
+    // Use the default run time.
+    if (run_time_index == 0) return;
+
+    const char* arg = argv[run_time_index];
     char* end;
-    unsigned long run_time = strtoul(argv[1], &end, 0);  // NOLINT(runtime/int)
-    if ((end == argv[1]) || (run_time > UINT32_MAX)) {
+    unsigned long run_time = strtoul(arg, &end, 0);  // NOLINT(runtime/int)
+    if ((end == arg) || (run_time > UINT32_MAX)) {
       PrintUsage(argv[0]);
       status_ = kExitFailure;
       return;
@@ -115,6 +135,11 @@ class BenchCLI {
     printf("\n");
     printf("    -h, --help\n");
     printf("        Print this help message.\n");
+    if (option_ != NULL) {
+      printf("\n");
+      printf("    %s\n", option_);
+      printf("        %s\n", option_help_);
+    }
   }
 
   void PrintResults(uint64_t iterations, double elapsed_seconds) {
@@ -156,12 +181,19 @@ class BenchCLI {
 
   uint32_t GetRunTimeInSeconds() const { return run_time_; }
 
+  // Return true if the benchmark-specific option was given.
+  bool IsOptionSet() const { return option_set_; }
+
  private:
   static const uint32_t kDefaultRunTime = 5;
 
   uint32_t run_time_;
 
   enum { kRunBenchmark, kExitSuccess, kExitFailure } status_;
+
+  const char* option_;
+  const char* option_help_;
+  bool option_set_;
 };
 
 // Generate random, but valid (and simulatable) instruction sequences.
@@ -172,7 +204,11 @@ class BenchCLI {
 class BenchCodeGenerator {
  public:
   explicit BenchCodeGenerator(vixl::aarch64::MacroAssembler* masm)
-      : masm_(masm), rnd_(0), rnd_bits_(0), call_depth_(0) {
+      : masm_(masm),
+        rnd_(0),
+        rnd_bits_(0),
+        call_depth_(0),
+        bulk_emission_(false) {
     // Arbitrarily initialise rand_state_ using the behaviour of srand48(42).
     rand_state_[2] = 0;
     rand_state_[1] = 42;
@@ -181,6 +217,10 @@ class BenchCodeGenerator {
 
   void Generate(size_t min_size_in_bytes);
 
+  // Emit each straight-line sequence in a BulkEmissionScope, rather than
+  // checking the pools and the buffer for each macro instruction.
+  void EnableBulkEmission(bool enable = true) { bulk_emission_ = enable; }
+
  private:
   void GeneratePrologue();
   void GenerateEpilogue();
@@ -251,6 +291,8 @@ class BenchCodeGenerator {
   // influenced by the current call depth, so we have to track it here.
   int call_depth_;
 
+  bool bulk_emission_;
+
   struct LabelPair {
     // We can't copy labels, so we have to allocate them dynamically to store
     // them in a std::list.
@@ -49,7 +49,10 @@ RawLiteral::RawLiteral(size_t size,
 }
 
 
-void Assembler::Reset() { GetBuffer()->Reset(); }
+void Assembler::Reset() {
+  GetBuffer()->Reset();
+  relocations_.clear();
+}
 
 
 void Assembler::bind(Label* label) {
@@ -67,23 +70,51 @@ void Assembler::BindToOffset(Label* label, ptrdiff_t offset) {
     Instruction* link =
         GetBuffer()->GetOffsetAddress<Instruction*>(*it.Current());
     link->SetImmPCOffsetTarget(GetLabelAddress<Instruction*>(label));
+    if (record_relocations_ && (link->Mask(PCRelAddressingMask) == ADRP)) {
+      ResolveAdrpRelocation(*it.Current(), offset);
+    }
   }
   label->ClearAllLinks();
 }
 
 
+void Assembler::ResolveAdrpRelocation(ptrdiff_t adrp_offset,
+                                      ptrdiff_t target_offset) {
+  // The relocation was recorded when the adrp was emitted, so search from the
+  // most recent one.
+  for (size_t i = relocations_.size(); i > 0; i--) {
+    Relocation* relocation = &relocations_[i - 1];
+    if ((relocation->kind == Relocation::kAdrpInternal) &&
+        (relocation->offset == adrp_offset)) {
+      VIXL_ASSERT(relocation->target == Relocation::kUnresolvedTarget);
+      relocation->target = target_offset;
+      return;
+    }
+  }
+  VIXL_UNREACHABLE();
+}
+
+
 // A common implementation for the LinkAndGet<Type>OffsetTo helpers.
 //
 // The offset is calculated by aligning the PC and label addresses down to a
 // multiple of 1 << element_shift, then calculating the (scaled) offset between
 // them. This matches the semantics of adrp, for example.
+//
+// The addresses are those at which the code will execute, which differ from
+// the addresses it is written to if the buffer is dual-mapped.
 template <int element_shift>
 ptrdiff_t Assembler::LinkAndGetOffsetTo(Label* label) {
   VIXL_STATIC_ASSERT(element_shift < (sizeof(ptrdiff_t) * 8));
 
   if (label->IsBound()) {
-    uintptr_t pc_offset = GetCursorAddress<uintptr_t>() >> element_shift;
-    uintptr_t label_offset = GetLabelAddress<uintptr_t>(label) >> element_shift;
+    const CodeBuffer* buffer = GetBuffer();
+    uintptr_t pc_offset =
+        buffer->GetExecutableOffsetAddress<uintptr_t>(GetCursorOffset()) >>
+        element_shift;
+    uintptr_t label_offset =
+        buffer->GetExecutableOffsetAddress<uintptr_t>(label->GetLocation()) >>
+        element_shift;
     return label_offset - pc_offset;
   } else {
     label->AddLink(GetBuffer()->GetCursorOffset());
@@ -462,6 +493,10 @@ void Assembler::adrp(const Register& xd, int64_t imm21) {
 
 void Assembler::adrp(const Register& xd, Label* label) {
   VIXL_ASSERT(AllowPageOffsetDependentCode());
+  RecordRelocation(Relocation::kAdrpInternal,
+                   GetCursorOffset(),
+                   label->IsBound() ? label->GetLocation()
+                                    : Relocation::kUnresolvedTarget);
   adrp(xd, static_cast<int>(LinkAndGetPageOffsetTo(label)));
 }
 
@@ -34,6 +34,7 @@
 #include "../invalset-vixl.h"
 #include "../utils-vixl.h"
 #include "operands-aarch64.h"
+#include "relocation-aarch64.h"
 
 namespace vixl {
 namespace aarch64 {
@@ -405,19 +406,23 @@ class Assembler : public vixl::internal::AssemblerBase {
  public:
   explicit Assembler(
       PositionIndependentCodeOption pic = PositionIndependentCode)
-      : pic_(pic), cpu_features_(CPUFeatures::AArch64LegacyBaseline()) {}
+      : pic_(pic),
+        cpu_features_(CPUFeatures::AArch64LegacyBaseline()),
+        record_relocations_(false) {}
   explicit Assembler(
       size_t capacity,
       PositionIndependentCodeOption pic = PositionIndependentCode)
       : AssemblerBase(capacity),
         pic_(pic),
-        cpu_features_(CPUFeatures::AArch64LegacyBaseline()) {}
+        cpu_features_(CPUFeatures::AArch64LegacyBaseline()),
+        record_relocations_(false) {}
   Assembler(byte* buffer,
             size_t capacity,
             PositionIndependentCodeOption pic = PositionIndependentCode)
       : AssemblerBase(buffer, capacity),
         pic_(pic),
-        cpu_features_(CPUFeatures::AArch64LegacyBaseline()) {}
+        cpu_features_(CPUFeatures::AArch64LegacyBaseline()),
+        record_relocations_(false) {}
 
   // Upon destruction, the code will assert that one of the following is true:
   //  * The Assembler object has not been used.
@@ -6554,6 +6559,26 @@ class Assembler : public vixl::internal::AssemblerBase {
            (GetPic() == PositionDependentCode);
   }
 
+  // Record a Relocation for each position-dependent site emitted from now on,
+  // so that the finished code can be moved with CopyAndRelocateCode().
+  // Relocations are discarded by Reset().
+  void SetRecordRelocations(bool value) { record_relocations_ = value; }
+  bool IsRecordingRelocations() const { return record_relocations_; }
+  const std::vector<Relocation>& GetRelocations() const {
+    return relocations_;
+  }
+
+  // Record a position-dependent site that the Assembler cannot identify by
+  // itself, such as a branch with a raw immediate offset to code outside of the
+  // buffer. This has no effect unless relocations are being recorded.
+  void RecordRelocation(Relocation::Kind kind,
+                        ptrdiff_t offset,
+                        uint64_t target) {
+    if (!record_relocations_) return;
+    Relocation relocation = {kind, offset, target};
+    relocations_.push_back(relocation);
+  }
+
   static Register AppropriateZeroRegFor(const CPURegister& reg) {
     return reg.Is64Bits() ? Register(xzr) : Register(wzr);
   }
@@ -7018,6 +7043,10 @@ class Assembler : public vixl::internal::AssemblerBase {
   // Literal load offset are in words (32-bit).
   ptrdiff_t LinkAndGetWordOffsetTo(RawLiteral* literal);
 
+  // Set the target of the kAdrpInternal relocation for the adrp at
+  // `adrp_offset`, whose label has just been bound to `target_offset`.
+  void ResolveAdrpRelocation(ptrdiff_t adrp_offset, ptrdiff_t target_offset);
+
   // Emit the instruction in buffer_.
   void Emit(Instr instruction) {
     VIXL_STATIC_ASSERT(sizeof(instruction) == kInstructionSize);
@@ -7028,6 +7057,9 @@ class Assembler : public vixl::internal::AssemblerBase {
   PositionIndependentCodeOption pic_;
 
   CPUFeatures cpu_features_;
+
+  bool record_relocations_;
+  std::vector<Relocation> relocations_;
 };
 
 
@@ -0,0 +1,626 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+#include <cstdio>
+#include <cstring>
+
+#include "code-cache-aarch64.h"
+
+#include "code-space-aarch64.h"
+#include "macro-assembler-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+namespace {
+
+// The file starts with a FileHeader, followed by an EntryRecord for each entry.
+// The rest of the file is referred to by offsets from the start of the file,
+// except for strings, which are referred to by offsets into the string table.
+// Imports and features are each recorded as the name of the import or feature.
+const char kMagic[8] = {'V', 'I', 'X', 'L', 'C', 'O', 'D', 'E'};
+const uint32_t kVersion = 1;
+// Written in host byte order, to reject files written by a different host.
+const uint32_t kByteOrderMark = 0x01020304;
+const size_t kCodeAlignment = 16;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order_mark;
+  uint32_t entry_count;
+  uint32_t import_count;
+  uint64_t imports_offset;
+  uint64_t strings_offset;
+  uint64_t strings_size;
+  uint64_t file_size;
+};
+
+struct EntryRecord {
+  uint64_t name;
+  uint64_t code_offset;
+  uint64_t code_size;
+  uint64_t relocations_offset;
+  uint64_t relocation_count;
+  uint64_t symbols_offset;
+  uint64_t symbol_count;
+  uint64_t features_offset;
+  uint64_t feature_count;
+};
+
+struct RelocationRecord {
+  uint32_t kind;
+  // The index of the import for external relocations.
+  uint32_t import;
+  uint64_t offset;
+  // The offset from the start of the code for kAdrpInternal, or from the
+  // import's address for everything else.
+  uint64_t target;
+};
+
+struct SymbolRecord {
+  uint64_t name;
+  uint64_t offset;
+};
+
+const char* const kFeatureNames[] = {
+#define VIXL_FEATURE_NAME(SYMBOL, NAME, CPUINFO) NAME,
+    VIXL_CPU_FEATURE_LIST(VIXL_FEATURE_NAME)
+#undef VIXL_FEATURE_NAME
+};
+
+bool LookUpFeature(const std::string& name, CPUFeatures::Feature* feature) {
+  for (int i = 0; i < CPUFeatures::kNumberOfFeatures; i++) {
+    if (name == kFeatureNames[i]) {
+      *feature = static_cast<CPUFeatures::Feature>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+// The name of the import for the simulator wrapper used to call the runtime
+// function imported as `function_name`.
+std::string GetWrapperImportName(const char* function_name) {
+  return std::string(function_name) + ".simulator_wrapper";
+}
+
+// The number of bytes of code that a relocation patches.
+size_t GetSiteSize(Relocation::Kind kind) {
+  switch (kind) {
+    case Relocation::kAdrpInternal:
+    case Relocation::kPCRelativeExternal:
+      return kInstructionSize;
+    case Relocation::kAbsolute64:
+      return sizeof(uint64_t);
+    case Relocation::kMovWide64:
+      return 4 * kInstructionSize;
+  }
+  VIXL_UNREACHABLE();
+  return 0;
+}
+
+template <typename T>
+void Append(std::vector<byte>* data, const T& value) {
+  const byte* bytes = reinterpret_cast<const byte*>(&value);
+  data->insert(data->end(), bytes, bytes + sizeof(value));
+}
+
+class StringTable {
+ public:
+  uint64_t Add(const std::string& string) {
+    std::map<std::string, uint64_t>::const_iterator it = offsets_.find(string);
+    if (it != offsets_.end()) return it->second;
+    uint64_t offset = data_.size();
+    data_.insert(data_.end(), string.begin(), string.end());
+    data_.push_back(0);
+    offsets_[string] = offset;
+    return offset;
+  }
+
+  const std::vector<byte>& GetData() const { return data_; }
+
+ private:
+  std::vector<byte> data_;
+  std::map<std::string, uint64_t> offsets_;
+};
+
+}  // namespace
+
+
+void CodeCacheWriter::AddImport(const char* name, const void* address) {
+  uint64_t key = reinterpret_cast<uintptr_t>(address);
+  VIXL_ASSERT(import_addresses_.find(key) == import_addresses_.end());
+  import_addresses_[key] = static_cast<uint32_t>(imports_.size());
+  imports_.push_back(name);
+}
+
+
+void CodeCacheWriter::AddRuntimeCallImport(const char* name,
+                                           uintptr_t function,
+                                           uintptr_t wrapper) {
+  AddImport(name, reinterpret_cast<const void*>(function));
+  if (wrapper == 0) return;
+  wrapper_addresses_.insert(wrapper);
+  wrapper_imports_[function] = static_cast<uint32_t>(imports_.size());
+  imports_.push_back(GetWrapperImportName(name));
+}
+
+
+size_t CodeCacheWriter::AddEntry(const char* name, MacroAssembler* masm) {
+  return AddEntry(name, masm, *masm->GetCPUFeatures());
+}
+
+
+size_t CodeCacheWriter::AddEntry(const char* name,
+                                 MacroAssembler* masm,
+                                 const CPUFeatures& required_features) {
+  VIXL_ASSERT(!masm->GetBuffer()->IsDirty());
+  VIXL_ASSERT(masm->GetSizeOfCodeGenerated() > 0);
+  for (size_t i = 0; i < entries_.size(); i++) {
+    VIXL_ASSERT(entries_[i].name != name);
+  }
+
+  entries_.push_back(Entry());
+  Entry* entry = &entries_.back();
+  entry->name = name;
+  entry->required_features = required_features;
+  const byte* start = masm->GetBuffer()->GetStartAddress<const byte*>();
+  entry->code.assign(start, start + masm->GetSizeOfCodeGenerated());
+
+  const std::vector<Relocation>& relocations = masm->GetRelocations();
+  for (size_t i = 0; i < relocations.size(); i++) {
+    ExternalRelocation relocation = {relocations[i], kNoImport};
+    if (relocation.relocation.kind == Relocation::kAdrpInternal) {
+      VIXL_ASSERT(relocation.relocation.target !=
+                  Relocation::kUnresolvedTarget);
+    } else if (wrapper_addresses_.count(relocation.relocation.target) != 0) {
+      relocation.import = GetWrapperImportFor(relocations, i);
+      relocation.relocation.target = 0;
+    } else {
+      uint64_t offset;
+      relocation.import = GetImportFor(relocation.relocation.target, &offset);
+      relocation.relocation.target = offset;
+    }
+    entry->relocations.push_back(relocation);
+  }
+  return entries_.size() - 1;
+}
+
+
+void CodeCacheWriter::AddSymbol(size_t entry,
+                                const char* name,
+                                const Label* label) {
+  VIXL_ASSERT(label->IsBound());
+  AddSymbol(entry, name, label->GetLocation());
+}
+
+
+void CodeCacheWriter::AddSymbol(size_t entry,
+                                const char* name,
+                                ptrdiff_t offset) {
+  VIXL_ASSERT(entry < entries_.size());
+  VIXL_ASSERT((offset >= 0) &&
+              (static_cast<size_t>(offset) < entries_[entry].code.size()));
+  Symbol symbol = {name, offset};
+  entries_[entry].symbols.push_back(symbol);
+}
+
+
+uint32_t CodeCacheWriter::GetImportFor(uint64_t address,
+                                       uint64_t* offset) const {
+  // Find the nearest import at or below `address`.
+  std::map<uint64_t, uint32_t>::const_iterator it =
+      import_addresses_.upper_bound(address);
+  if (it == import_addresses_.begin()) {
+    VIXL_ABORT_WITH_MSG("Relocation target is not a declared import.\n");
+  }
+  --it;
+  *offset = address - it->first;
+  return it->second;
+}
+
+
+uint32_t CodeCacheWriter::GetWrapperImportFor(
+    const std::vector<Relocation>& relocations, size_t i) const {
+  // A simulated runtime call holds the wrapper's address, then the function's.
+  const ptrdiff_t kFunctionOffset =
+      kRuntimeCallFunctionOffset - kRuntimeCallWrapperOffset;
+  const Relocation& wrapper = relocations[i];
+  if (((i + 1) < relocations.size()) &&
+      (relocations[i + 1].kind == Relocation::kAbsolute64) &&
+      (relocations[i + 1].offset == (wrapper.offset + kFunctionOffset))) {
+    std::map<uint64_t, uint32_t>::const_iterator it =
+        wrapper_imports_.find(relocations[i + 1].target);
+    if (it != wrapper_imports_.end()) return it->second;
+  }
+  VIXL_ABORT_WITH_MSG(
+      "Runtime call target is not declared with AddRuntimeCallImport().\n");
+  return kNoImport;
+}
+
+
+void CodeCacheWriter::Serialise(std::vector<byte>* data) const {
+  StringTable strings;
+  // Imports, relocations, symbols and features.
+  std::vector<byte> tables;
+  std::vector<byte> code;
+  std::vector<EntryRecord> records(entries_.size());
+
+  size_t tables_offset =
+      sizeof(FileHeader) + (entries_.size() * sizeof(EntryRecord));
+
+  uint64_t imports_offset = tables_offset;
+  for (size_t i = 0; i < imports_.size(); i++) {
+    Append(&tables, strings.Add(imports_[i]));
+  }
+
+  for (size_t i = 0; i < entries_.size(); i++) {
+    const Entry& entry = entries_[i];
+    EntryRecord* record = &records[i];
+    record->name = strings.Add(entry.name);
+
+    record->relocations_offset = tables_offset + tables.size();
+    record->relocation_count = entry.relocations.size();
+    for (size_t j = 0; j < entry.relocations.size(); j++) {
+      const Relocation& relocation = entry.relocations[j].relocation;
+      RelocationRecord relocation_record = {static_cast<uint32_t>(
+                                                relocation.kind),
+                                            entry.relocations[j].import,
+                                            static_cast<uint64_t>(
+                                                relocation.offset),
+                                            relocation.target};
+      Append(&tables, relocation_record);
+    }
+
+    record->symbols_offset = tables_offset + tables.size();
+    record->symbol_count = entry.symbols.size();
+    for (size_t j = 0; j < entry.symbols.size(); j++) {
+      SymbolRecord symbol_record = {strings.Add(entry.symbols[j].name),
+                                    static_cast<uint64_t>(
+                                        entry.symbols[j].offset)};
+      Append(&tables, symbol_record);
+    }
+
+    record->features_offset = tables_offset + tables.size();
+    record->feature_count = entry.required_features.Count();
+    for (CPUFeatures::const_iterator it = entry.required_features.begin();
+         it != entry.required_features.end();
+         ++it) {
+      Append(&tables, strings.Add(kFeatureNames[*it]));
+    }
+
+    // The code offset is fixed up below, once the size of the tables is known.
+    record->code_offset = code.size();
+    record->code_size = entry.code.size();
+    code.insert(code.end(), entry.code.begin(), entry.code.end());
+    code.resize(AlignUp(code.size(), kCodeAlignment), 0);
+  }
+
+  size_t code_offset = AlignUp(tables_offset + tables.size(), kCodeAlignment);
+  for (size_t i = 0; i < records.size(); i++) {
+    records[i].code_offset += code_offset;
+  }
+
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.byte_order_mark = kByteOrderMark;
+  header.entry_count = static_cast<uint32_t>(entries_.size());
+  header.import_count = static_cast<uint32_t>(imports_.size());
+  header.imports_offset = imports_offset;
+  header.strings_offset = code_offset + code.size();
+  header.strings_size = strings.GetData().size();
+  header.file_size = header.strings_offset + header.strings_size;
+
+  data->clear();
+  data->reserve(header.file_size);
+  Append(data, header);
+  for (size_t i = 0; i < records.size(); i++) {
+    Append(data, records[i]);
+  }
+  data->insert(data->end(), tables.begin(), tables.end());
+  data->resize(code_offset, 0);
+  data->insert(data->end(), code.begin(), code.end());
+  data->insert(data->end(),
+               strings.GetData().begin(),
+               strings.GetData().end());
+  VIXL_ASSERT(data->size() == header.file_size);
+}
+
+
+bool CodeCacheWriter::WriteToFile(const char* path) const {
+  std::vector<byte> data;
+  Serialise(&data);
+
+  std::string temp_path = std::string(path) + ".tmp";
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (file == NULL) return false;
+  bool success = fwrite(data.data(), 1, data.size(), file) == data.size();
+  success = (fclose(file) == 0) && success;
+  if (success) success = (rename(temp_path.c_str(), path) == 0);
+  if (!success) remove(temp_path.c_str());
+  return success;
+}
+
+
+CodeCache::CodeCache(CodeSpace* space, const CPUFeatures& available_features)
+    : space_(space),
+      available_features_(available_features),
+      data_(NULL),
+      size_(0),
+      strings_offset_(0),
+      strings_size_(0),
+      loaded_entry_count_(0) {}
+
+
+CodeCache::~CodeCache() { Close(); }
+
+
+bool CodeCache::Open(const char* path) {
+  VIXL_ASSERT(!IsOpen());
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+
+  void* data = MAP_FAILED;
+  size_t size = 0;
+  struct stat info;
+  if ((fstat(fd, &info) == 0) && (info.st_size > 0)) {
+    size = static_cast<size_t>(info.st_size);
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // The mapping keeps the file alive.
+  close(fd);
+  if (data == MAP_FAILED) return false;
+
+  data_ = static_cast<const byte*>(data);
+  size_ = size;
+  if (!ReadIndex()) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+
+void CodeCache::Close() {
+  // Loaded code has been copied into the CodeSpace, so it is not affected.
+  if (data_ != NULL) munmap(const_cast<byte*>(data_), size_);
+  data_ = NULL;
+  size_ = 0;
+  strings_offset_ = 0;
+  strings_size_ = 0;
+  entries_.clear();
+  import_names_.clear();
+}
+
+
+void CodeCache::DefineImport(const char* name, const void* address) {
+  import_addresses_[name] = reinterpret_cast<uintptr_t>(address);
+}
+
+
+void CodeCache::DefineRuntimeCallImport(const char* name,
+                                        uintptr_t function,
+                                        uintptr_t wrapper) {
+  import_addresses_[name] = function;
+  if (wrapper != 0) import_addresses_[GetWrapperImportName(name)] = wrapper;
+}
+
+
+bool CodeCache::HasEntry(const char* name) const {
+  return FindEntry(name) != NULL;
+}
+
+
+bool CodeCache::IsEntryCompatible(const char* name) const {
+  const EntryInfo* entry = FindEntry(name);
+  return (entry != NULL) && IsCompatible(*entry);
+}
+
+
+void* CodeCache::GetEntry(const char* name) {
+  EntryInfo* entry = FindEntry(name);
+  return (entry == NULL) ? NULL : Load(entry);
+}
+
+
+void* CodeCache::GetSymbol(const char* entry_name, const char* symbol) {
+  EntryInfo* entry = FindEntry(entry_name);
+  if (entry == NULL) return NULL;
+  byte* code = static_cast<byte*>(Load(entry));
+  if (code == NULL) return NULL;
+
+  EntryRecord record;
+  VIXL_CHECK(Read(entry->record_offset, &record));
+  for (uint64_t i = 0; i < record.symbol_count; i++) {
+    SymbolRecord symbol_record;
+    std::string name;
+    if (!Read(record.symbols_offset + (i * sizeof(symbol_record)),
+              &symbol_record) ||
+        !ReadString(symbol_record.name, &name)) {
+      return NULL;
+    }
+    if (name == symbol) {
+      if (symbol_record.offset >= record.code_size) return NULL;
+      return code + symbol_record.offset;
+    }
+  }
+  return NULL;
+}
+
+
+template <typename T>
+bool CodeCache::Read(uint64_t offset, T* value) const {
+  if ((offset > size_) || (sizeof(*value) > (size_ - offset))) return false;
+  memcpy(value, data_ + offset, sizeof(*value));
+  return true;
+}
+
+
+bool CodeCache::ReadString(uint64_t offset, std::string* string) const {
+  if (offset >= strings_size_) return false;
+  const char* start =
+      reinterpret_cast<const char*>(data_ + strings_offset_ + offset);
+  const void* end = memchr(start, 0, strings_size_ - offset);
+  if (end == NULL) return false;
+  string->assign(start, static_cast<const char*>(end));
+  return true;
+}
+
+
+bool CodeCache::ReadIndex() {
+  FileHeader header;
+  if (!Read(0, &header)) return false;
+  if ((memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) ||
+      (header.version != kVersion) ||
+      (header.byte_order_mark != kByteOrderMark) ||
+      (header.file_size != size_) || (header.strings_offset > size_) ||
+      (header.strings_size > (size_ - header.strings_offset))) {
+    return false;
+  }
+  strings_offset_ = header.strings_offset;
+  strings_size_ = header.strings_size;
+
+  for (uint32_t i = 0; i < header.import_count; i++) {
+    uint64_t name_offset;
+    std::string name;
+    if (!Read(header.imports_offset + (i * sizeof(name_offset)),
+              &name_offset) ||
+        !ReadString(name_offset, &name)) {
+      return false;
+    }
+    import_names_.push_back(name);
+  }
+
+  // Only the names and code bounds are checked here. The rest of each entry is
+  // checked when it is loaded.
+  for (uint32_t i = 0; i < header.entry_count; i++) {
+    size_t record_offset = sizeof(header) + (i * sizeof(EntryRecord));
+    EntryRecord record;
+    std::string name;
+    if (!Read(record_offset, &record) || !ReadString(record.name, &name)) {
+      return false;
+    }
+    if ((record.code_size == 0) || (record.code_offset > size_) ||
+        (record.code_size > (size_ - record.code_offset))) {
+      return false;
+    }
+    EntryInfo entry = {record_offset, NULL};
+    entries_.insert(std::make_pair(name, entry));
+  }
+  return true;
+}
+
+
+CodeCache::EntryInfo* CodeCache::FindEntry(const char* name) {
+  std::map<std::string, EntryInfo>::iterator it = entries_.find(name);
+  return (it == entries_.end()) ? NULL : &it->second;
+}
+
+
+const CodeCache::EntryInfo* CodeCache::FindEntry(const char* name) const {
+  std::map<std::string, EntryInfo>::const_iterator it = entries_.find(name);
+  return (it == entries_.end()) ? NULL : &it->second;
+}
+
+
+bool CodeCache::IsCompatible(const EntryInfo& entry) const {
+  EntryRecord record;
+  VIXL_CHECK(Read(entry.record_offset, &record));
+  for (uint64_t i = 0; i < record.feature_count; i++) {
+    uint64_t name_offset;
+    std::string name;
+    CPUFeatures::Feature feature;
+    // Features that this version of VIXL does not know about cannot be
+    // available.
+    if (!Read(record.features_offset + (i * sizeof(name_offset)),
+              &name_offset) ||
+        !ReadString(name_offset, &name) || !LookUpFeature(name, &feature) ||
+        !available_features_.Has(feature)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void* CodeCache::Load(EntryInfo* entry) {
+  if (entry->code != NULL) return entry->code;
+  if (!IsCompatible(*entry)) return NULL;
+
+  EntryRecord record;
+  VIXL_CHECK(Read(entry->record_offset, &record));
+  std::vector<Relocation> relocations;
+  relocations.reserve(record.relocation_count);
+  for (uint64_t i = 0; i < record.relocation_count; i++) {
+    RelocationRecord relocation_record;
+    if (!Read(record.relocations_offset + (i * sizeof(relocation_record)),
+              &relocation_record) ||
+        (relocation_record.kind >
+         static_cast<uint32_t>(Relocation::kMovWide64))) {
+      return NULL;
+    }
+    Relocation relocation = {static_cast<Relocation::Kind>(
+                                 relocation_record.kind),
+                             static_cast<ptrdiff_t>(relocation_record.offset),
+                             relocation_record.target};
+    size_t site_size = GetSiteSize(relocation.kind);
+    if ((site_size > record.code_size) ||
+        (relocation_record.offset > (record.code_size - site_size))) {
+      return NULL;
+    }
+    if (relocation.kind == Relocation::kAdrpInternal) {
+      if (relocation.target >= record.code_size) return NULL;
+    } else {
+      // Imports are resolved now, rather than when the file is opened, so
+      // they only need to be defined for the entries that are used.
+      if (relocation_record.import >= import_names_.size()) return NULL;
+      std::map<std::string, uint64_t>::const_iterator it =
+          import_addresses_.find(import_names_[relocation_record.import]);
+      if (it == import_addresses_.end()) return NULL;
+      relocation.target += it->second;
+    }
+    relocations.push_back(relocation);
+  }
+
+  entry->code = space_->Commit(data_ + record.code_offset,
+                               record.code_size,
+                               relocations);
+  loaded_entry_count_++;
+  return entry->code;
+}
+
+}  // namespace aarch64
+}  // namespace vixl
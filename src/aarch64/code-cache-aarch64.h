@@ -0,0 +1,273 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VIXL_AARCH64_CODE_CACHE_AARCH64_H_
+#define VIXL_AARCH64_CODE_CACHE_AARCH64_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../cpu-features.h"
+#include "../globals-vixl.h"
+
+#include "macro-assembler-aarch64.h"
+#include "relocation-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+class CodeSpace;
+
+// A persistent cache of finished code, such as a process's stubs and
+// trampolines, so that they do not have to be regenerated every time the
+// process starts.
+//
+// A cache file holds any number of named entries. Each entry records:
+//  - the code bytes,
+//  - the relocations needed to run the code from a new address,
+//  - a table of named offsets into the code (symbols), and
+//  - the CPUFeatures that the code requires.
+//
+// External addresses, such as the targets of runtime calls, differ from one
+// process to the next, so they are recorded by name. Every external relocation
+// target must be declared as an import when the cache is written, and must be
+// defined again when it is loaded. A target may also lie inside an import,
+// such as a field of an imported structure; it is recorded as an offset from
+// the nearest import at or below it. Functions called with
+// MacroAssembler::CallRuntime() or TailCallRuntime() must be declared with
+// AddRuntimeCallImport() and defined with DefineRuntimeCallImport(), because
+// code generated for the simulator also refers to a simulator wrapper for the
+// function's signature.
+//
+// Features are recorded by name, so a cache file does not depend on the
+// numbering of CPUFeatures::Feature.
+//
+// This requires VIXL_CODE_BUFFER_MMAP.
+class CodeCacheWriter {
+ public:
+  CodeCacheWriter() {}
+
+  // Declare an external address that the cached code refers to.
+  void AddImport(const char* name, const void* address);
+
+#ifdef VIXL_HAS_MACROASSEMBLER_RUNTIME_CALL_SUPPORT
+  // Declare a function that the cached code calls with CallRuntime() or
+  // TailCallRuntime(). This also declares the simulator wrapper for the call,
+  // if there is one.
+  template <typename R, typename... P>
+  void AddRuntimeCallImport(const char* name, R (*function)(P...)) {
+    uintptr_t wrapper = 0;
+#ifdef VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT
+    wrapper = reinterpret_cast<uintptr_t>(
+        &(Simulator::RuntimeCallStructHelper<R, P...>::Wrapper));
+#endif
+    AddRuntimeCallImport(name, reinterpret_cast<uintptr_t>(function), wrapper);
+  }
+#endif
+
+  // Add all of the code generated by `masm`, which must have been finalised,
+  // and which must have recorded relocations if it refers to anything outside
+  // of itself. The entry requires the CPUFeatures that `masm` was allowed to
+  // use, unless `required_features` is specified.
+  //
+  // This returns an index for use with AddSymbol().
+  size_t AddEntry(const char* name, MacroAssembler* masm);
+  size_t AddEntry(const char* name,
+                  MacroAssembler* masm,
+                  const CPUFeatures& required_features);
+
+  // Name an offset into the code of `entry`, such as the start of one stub in a
+  // set of stubs generated together. `label` must be bound.
+  void AddSymbol(size_t entry, const char* name, const Label* label);
+  void AddSymbol(size_t entry, const char* name, ptrdiff_t offset);
+
+  // Serialise the cache. The file is written under a temporary name and then
+  // renamed, so that a process that is loading the cache never sees a partial
+  // file. Returns false if the file could not be written.
+  bool WriteToFile(const char* path) const;
+
+  // Serialise the cache into `data`.
+  void Serialise(std::vector<byte>* data) const;
+
+ private:
+  static const uint32_t kNoImport = UINT32_MAX;
+
+  struct Symbol {
+    std::string name;
+    ptrdiff_t offset;
+  };
+
+  // For external relocations, `relocation.target` holds the offset from the
+  // address of the import.
+  struct ExternalRelocation {
+    Relocation relocation;
+    uint32_t import;
+  };
+
+  struct Entry {
+    std::string name;
+    std::vector<byte> code;
+    std::vector<ExternalRelocation> relocations;
+    std::vector<Symbol> symbols;
+    CPUFeatures required_features;
+  };
+
+  void AddRuntimeCallImport(const char* name,
+                            uintptr_t function,
+                            uintptr_t wrapper);
+
+  // Find the nearest import at or below `address`, and the offset of
+  // `address` from it.
+  uint32_t GetImportFor(uint64_t address, uint64_t* offset) const;
+  // Find the import for the simulator wrapper referred to by `relocations[i]`.
+  uint32_t GetWrapperImportFor(const std::vector<Relocation>& relocations,
+                               size_t i) const;
+
+  std::vector<std::string> imports_;
+  std::map<uint64_t, uint32_t> import_addresses_;
+  // Functions with the same signature share a simulator wrapper, so wrappers
+  // are imported once for each function, and found through the function.
+  std::set<uint64_t> wrapper_addresses_;
+  std::map<uint64_t, uint32_t> wrapper_imports_;
+  std::vector<Entry> entries_;
+};
+
+
+// Load code from a file written by CodeCacheWriter.
+//
+// The file is mapped, rather than read, and only its index is parsed by
+// Open(). The code for an entry is copied into a CodeSpace and relocated on
+// first use, so a process only pays for the entries that it actually uses.
+// As with any code committed to a CodeSpace, loaded code must be published
+// (with CodeSpace::Publish()) before it is run. This allows several entries to
+// be loaded with a single round of cache maintenance.
+//
+// An entry is rejected (and its lookup returns NULL) if it requires any
+// CPUFeatures that are not available, or refers to an import that has not been
+// defined. A corrupt or incompatible file is rejected as a whole by Open().
+class CodeCache {
+ public:
+  // Code is loaded into `space`, and stays there after the CodeCache is
+  // destroyed. Entries are accepted if they require no more than
+  // `available_features`.
+  explicit CodeCache(
+      CodeSpace* space,
+      const CPUFeatures& available_features = CPUFeatures::InferFromOS());
+  ~CodeCache();
+
+  CodeCache(const CodeCache& other) = delete;
+  CodeCache& operator=(const CodeCache& other) = delete;
+
+  // Map the cache file at `path`, and read its index. Returns false if the file
+  // could not be opened, or is not a valid cache file.
+  bool Open(const char* path);
+  void Close();
+  bool IsOpen() const { return data_ != NULL; }
+
+  // Provide the address of an import for the current process. This must be
+  // done before any entry that uses the import is loaded.
+  void DefineImport(const char* name, const void* address);
+
+#ifdef VIXL_HAS_MACROASSEMBLER_RUNTIME_CALL_SUPPORT
+  // Provide the address of a function declared with
+  // CodeCacheWriter::AddRuntimeCallImport().
+  template <typename R, typename... P>
+  void DefineRuntimeCallImport(const char* name, R (*function)(P...)) {
+    uintptr_t wrapper = 0;
+#ifdef VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT
+    wrapper = reinterpret_cast<uintptr_t>(
+        &(Simulator::RuntimeCallStructHelper<R, P...>::Wrapper));
+#endif
+    DefineRuntimeCallImport(name,
+                            reinterpret_cast<uintptr_t>(function),
+                            wrapper);
+  }
+#endif
+
+  size_t GetEntryCount() const { return entries_.size(); }
+  bool HasEntry(const char* name) const;
+
+  // Returns true if the entry exists and only requires available features.
+  bool IsEntryCompatible(const char* name) const;
+
+  // Return the address that the code of entry `name` will be run from, loading
+  // it first if necessary. Returns NULL if there is no such entry, or if it is
+  // rejected.
+  void* GetEntry(const char* name);
+
+  // As GetEntry(), but return the address of the named symbol in the entry.
+  void* GetSymbol(const char* entry, const char* symbol);
+
+  // The number of entries that have been loaded so far.
+  size_t GetLoadedEntryCount() const { return loaded_entry_count_; }
+
+  const CPUFeatures& GetAvailableFeatures() const {
+    return available_features_;
+  }
+
+ private:
+  struct EntryInfo {
+    // The offset of the entry's record in the file.
+    size_t record_offset;
+    // NULL until the entry is loaded.
+    void* code;
+  };
+
+  void DefineRuntimeCallImport(const char* name,
+                               uintptr_t function,
+                               uintptr_t wrapper);
+
+  bool ReadIndex();
+  bool ReadString(uint64_t offset, std::string* string) const;
+  template <typename T>
+  bool Read(uint64_t offset, T* value) const;
+
+  EntryInfo* FindEntry(const char* name);
+  const EntryInfo* FindEntry(const char* name) const;
+  bool IsCompatible(const EntryInfo& entry) const;
+  void* Load(EntryInfo* entry);
+
+  CodeSpace* space_;
+  CPUFeatures available_features_;
+
+  const byte* data_;
+  size_t size_;
+  uint64_t strings_offset_;
+  uint64_t strings_size_;
+
+  std::map<std::string, EntryInfo> entries_;
+  // The names of the file's imports, in file order.
+  std::vector<std::string> import_names_;
+  std::map<std::string, uint64_t> import_addresses_;
+  size_t loaded_entry_count_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_CODE_CACHE_AARCH64_H_
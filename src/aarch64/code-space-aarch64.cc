@@ -0,0 +1,219 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+
+#include "code-space-aarch64.h"
+
+#include "macro-assembler-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+CodeSpace::CodeSpace(size_t region_size, CacheMaintenanceBackend* backend)
+    : region_size_(region_size),
+      cache_maintenance_(backend),
+      allocated_bytes_(0) {
+  VIXL_ASSERT(IsMultiple(region_size_, kPageSize));
+}
+
+
+CodeSpace::~CodeSpace() {
+  for (size_t i = 0; i < regions_.size(); i++) {
+    // Code that was never published does not need to be finalised.
+    regions_[i]->SetClean();
+    delete regions_[i];
+  }
+}
+
+
+size_t CodeSpace::GetAllocationSize(size_t size) {
+  if (size > kPageSize) return AlignUp(size, kPageSize);
+  size_t allocation_size = kMinAllocationSize;
+  while (allocation_size < size) allocation_size *= 2;
+  return allocation_size;
+}
+
+
+int CodeSpace::GetSizeClass(size_t allocation_size) {
+  VIXL_STATIC_ASSERT((kMinAllocationSize << (kSizeClassCount - 1)) ==
+                     kPageSize);
+  VIXL_ASSERT(IsPowerOf2(allocation_size));
+  VIXL_ASSERT((allocation_size >= kMinAllocationSize) &&
+              (allocation_size <= kPageSize));
+  int size_class = 0;
+  while ((kMinAllocationSize << size_class) < allocation_size) size_class++;
+  return size_class;
+}
+
+
+void* CodeSpace::Commit(const void* code, size_t size) {
+  VIXL_ASSERT(size > 0);
+  Allocation allocation = Allocate(GetAllocationSize(size));
+  CodeBuffer* region = allocation.region;
+  MakeWritable(region);
+  region->UpdateData(allocation.offset, code, size);
+
+  uintptr_t address =
+      region->GetExecutableOffsetAddress<uintptr_t>(allocation.offset);
+  live_[address] = allocation;
+  allocated_bytes_ += allocation.size;
+  // Flush whole allocations, so that neighbouring allocations can be merged
+  // into a single range.
+  cache_maintenance_.Add(reinterpret_cast<void*>(address), allocation.size);
+  return reinterpret_cast<void*>(address);
+}
+
+
+void* CodeSpace::Commit(const void* code,
+                        size_t size,
+                        const std::vector<Relocation>& relocations) {
+  void* address = Commit(code, size);
+  if (!relocations.empty()) {
+    // The region is still writable, because it has not been published since
+    // the code was copied into it.
+    const Allocation& allocation = live_[reinterpret_cast<uintptr_t>(address)];
+    RelocateCode(allocation.region->GetOffsetAddress<void*>(allocation.offset),
+                 reinterpret_cast<uintptr_t>(address),
+                 size,
+                 relocations);
+  }
+  return address;
+}
+
+
+void* CodeSpace::Commit(MacroAssembler* masm) {
+  VIXL_ASSERT(masm->IsRecordingRelocations() ||
+              !masm->AllowPageOffsetDependentCode());
+  VIXL_ASSERT(!masm->GetBuffer()->IsDirty());
+  return Commit(masm->GetBuffer()->GetStartAddress<const void*>(),
+                masm->GetSizeOfCodeGenerated(),
+                masm->GetRelocations());
+}
+
+
+void CodeSpace::Publish() {
+  for (size_t i = 0; i < regions_.size(); i++) {
+    if (regions_[i]->IsDirty()) {
+      regions_[i]->SetExecutable();
+      regions_[i]->SetClean();
+    }
+  }
+  cache_maintenance_.Flush();
+}
+
+
+void CodeSpace::Free(void* code) {
+  std::map<uintptr_t, Allocation>::iterator it =
+      live_.find(reinterpret_cast<uintptr_t>(code));
+  VIXL_ASSERT(it != live_.end());
+  allocated_bytes_ -= it->second.size;
+  AddToFreeList(it->second);
+  live_.erase(it);
+}
+
+
+CodeSpace::Allocation CodeSpace::Allocate(size_t allocation_size) {
+  std::vector<Allocation>* free_list;
+  if (allocation_size <= kPageSize) {
+    free_list = &free_lists_[GetSizeClass(allocation_size)];
+  } else {
+    free_list = &large_free_lists_[allocation_size];
+  }
+  if (!free_list->empty()) {
+    Allocation allocation = free_list->back();
+    free_list->pop_back();
+    return allocation;
+  }
+  return AllocateFromRegion(allocation_size);
+}
+
+
+CodeSpace::Allocation CodeSpace::AllocateFromRegion(size_t allocation_size) {
+  // Align allocations up to a page to their own size, so that they never
+  // straddle a page boundary. Larger allocations start on a page boundary.
+  size_t alignment = std::min(allocation_size, static_cast<size_t>(kPageSize));
+
+  CodeBuffer* region = regions_.empty() ? NULL : regions_.back();
+  if (region != NULL) {
+    size_t offset = region->GetCursorOffset();
+    size_t padding = AlignUp(offset, alignment) - offset;
+    if (!region->HasSpaceFor(padding + allocation_size)) region = NULL;
+  }
+  if (region == NULL) {
+    region = AddRegion(std::max(region_size_, allocation_size));
+  }
+  MakeWritable(region);
+
+  // Reuse the padding for smaller allocations.
+  ptrdiff_t offset = region->GetCursorOffset();
+  ptrdiff_t aligned_offset = AlignUp(offset, alignment);
+  while (offset < aligned_offset) {
+    size_t size = kMinAllocationSize;
+    while (IsMultiple(offset, 2 * size) &&
+           ((offset + static_cast<ptrdiff_t>(2 * size)) <= aligned_offset)) {
+      size *= 2;
+    }
+    Allocation padding = {region, offset, size};
+    AddToFreeList(padding);
+    offset += size;
+  }
+
+  region->EmitZeroedBytes(static_cast<int>(
+      (aligned_offset - region->GetCursorOffset()) + allocation_size));
+  Allocation allocation = {region, aligned_offset, allocation_size};
+  return allocation;
+}
+
+
+void CodeSpace::AddToFreeList(const Allocation& allocation) {
+  if (allocation.size <= kPageSize) {
+    free_lists_[GetSizeClass(allocation.size)].push_back(allocation);
+  } else {
+    large_free_lists_[allocation.size].push_back(allocation);
+  }
+}
+
+
+void CodeSpace::MakeWritable(CodeBuffer* region) {
+  // A region is dirty from the first write after it was published until it is
+  // published again, and stays writable for all of that time.
+  if (!region->IsDirty()) region->SetWritable();
+}
+
+
+CodeBuffer* CodeSpace::AddRegion(size_t size) {
+  CodeBuffer* region = new CodeBuffer(size);
+  if (CodeBuffer::IsDualMappingSupported()) region->EnableDualMapping();
+  // Allocations are placed by their offset in the region, so the region itself
+  // must be page-aligned.
+  VIXL_ASSERT(IsAligned(region->GetStartAddress<uintptr_t>(), kPageSize));
+  regions_.push_back(region);
+  return region;
+}
+
+}  // namespace aarch64
+}  // namespace vixl
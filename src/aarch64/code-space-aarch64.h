@@ -0,0 +1,149 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VIXL_AARCH64_CODE_SPACE_AARCH64_H_
+#define VIXL_AARCH64_CODE_SPACE_AARCH64_H_
+
+#include <map>
+#include <vector>
+
+#include "../code-buffer-vixl.h"
+#include "../globals-vixl.h"
+
+#include "cpu-aarch64.h"
+#include "relocation-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+class MacroAssembler;
+
+// A shared allocator of executable memory for many small pieces of generated
+// code, such as stubs and trampolines.
+//
+// Code is generated into an ordinary, scratch MacroAssembler, and is then
+// copied into the CodeSpace with Commit(). Allocations are rounded up to a size
+// class and packed into large regions, so that many stubs share a page (and an
+// iTLB entry). Allocations no larger than a page never straddle a page
+// boundary. Freed allocations are kept on per-size-class free lists, and are
+// reused by later commits.
+//
+// Committed code cannot be run until Publish() is called. Publish() makes every
+// region that was written to executable, and performs the cache maintenance
+// for all of the code committed since the last Publish() as a single
+// CacheMaintenanceBatch.
+//
+// Regions are dual-mapped where CodeBuffer supports it, so code that has
+// already been published can keep running while new code is committed to the
+// same region. Otherwise, committing to a region makes the whole region
+// writable, and so not executable, until the next Publish().
+//
+// Committed code is moved, so it must not depend on its address, unless it is
+// committed from a MacroAssembler that recorded relocations for it.
+//
+// This requires VIXL_CODE_BUFFER_MMAP.
+class CodeSpace {
+ public:
+  static const size_t kDefaultRegionSize = 256 * KBytes;
+
+  // The smallest size class. Every allocation is aligned to this.
+  static const size_t kMinAllocationSize = 16;
+
+  // The cache maintenance is done through `backend`, or through
+  // CacheMaintenanceBackend::GetHost() if it is NULL.
+  explicit CodeSpace(size_t region_size = kDefaultRegionSize,
+                     CacheMaintenanceBackend* backend = NULL);
+  ~CodeSpace();
+
+  // Copy `size` bytes of code into the space, and return the address that it
+  // will be executed from once it has been published.
+  void* Commit(const void* code, size_t size);
+
+  // Copy `size` bytes of code into the space, and apply `relocations` to the
+  // copy (see RelocateCode()).
+  void* Commit(const void* code,
+               size_t size,
+               const std::vector<Relocation>& relocations);
+
+  // Copy all of the code generated by `masm`, which must have been finalised,
+  // and apply any relocations that it recorded.
+  void* Commit(MacroAssembler* masm);
+
+  // Make all of the code committed since the last call executable.
+  void Publish();
+
+  // Release code returned by Commit(), so that its space can be reused. The
+  // code must not be running, and must not be run again.
+  void Free(void* code);
+
+  // The number of bytes that an allocation of `size` bytes actually uses.
+  static size_t GetAllocationSize(size_t size);
+
+  size_t GetRegionCount() const { return regions_.size(); }
+
+  // The number of bytes used by live (committed and not freed) allocations.
+  size_t GetAllocatedBytes() const { return allocated_bytes_; }
+
+  bool HasUnpublishedCode() const { return !cache_maintenance_.IsEmpty(); }
+
+  const CacheMaintenanceStats& GetCacheMaintenanceStats() const {
+    return cache_maintenance_.GetStats();
+  }
+
+ private:
+  struct Allocation {
+    CodeBuffer* region;
+    ptrdiff_t offset;
+    size_t size;
+  };
+
+  // Allocations of up to kPageSize bytes use power-of-two size classes, from
+  // kMinAllocationSize upwards. Larger allocations are a whole number of pages,
+  // and have a free list per size.
+  static const int kSizeClassCount = 9;
+  static int GetSizeClass(size_t allocation_size);
+
+  Allocation Allocate(size_t allocation_size);
+  Allocation AllocateFromRegion(size_t allocation_size);
+  void AddToFreeList(const Allocation& allocation);
+  void MakeWritable(CodeBuffer* region);
+  CodeBuffer* AddRegion(size_t size);
+
+  size_t region_size_;
+  std::vector<CodeBuffer*> regions_;
+  std::vector<Allocation> free_lists_[kSizeClassCount];
+  std::map<size_t, std::vector<Allocation> > large_free_lists_;
+  // Live allocations, indexed by their executable address.
+  std::map<uintptr_t, Allocation> live_;
+  // The code committed since the last Publish().
+  CacheMaintenanceBatch cache_maintenance_;
+  size_t allocated_bytes_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_CODE_SPACE_AARCH64_H_
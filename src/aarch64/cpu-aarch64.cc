@@ -29,6 +29,8 @@
 #define VIXL_USE_LINUX_HWCAP 1
 #endif
 
+#include <algorithm>
+
 #include "../utils-vixl.h"
 
 #include "cpu-aarch64.h"
@@ -485,5 +487,142 @@ void CPU::EnsureIAndDCacheCoherency(void *address, size_t length) {
 #endif
 }
 
+
+namespace {
+
+// Cache maintenance using the host's instructions. See
+// CPU::EnsureIAndDCacheCoherency() for a description of each operation.
+class HostCacheMaintenanceBackend : public CacheMaintenanceBackend {
+ public:
+  virtual unsigned GetDCacheLineSize() const VIXL_OVERRIDE {
+    return CPU::GetDCacheLineSize();
+  }
+  virtual unsigned GetICacheLineSize() const VIXL_OVERRIDE {
+    return CPU::GetICacheLineSize();
+  }
+
+  virtual void CleanDCacheLines(uintptr_t start, uintptr_t end) VIXL_OVERRIDE {
+#ifdef __aarch64__
+    for (uintptr_t line = start; line < end; line += GetDCacheLineSize()) {
+      __asm__ __volatile__("   dc    cvau, %[line]\n"
+                           :
+                           : [line] "r"(line)
+                           : "memory");
+    }
+#else
+    USE(start, end);
+#endif
+  }
+
+  virtual void InvalidateICacheLines(uintptr_t start,
+                                     uintptr_t end) VIXL_OVERRIDE {
+#ifdef __aarch64__
+    for (uintptr_t line = start; line < end; line += GetICacheLineSize()) {
+      __asm__ __volatile__("   ic   ivau, %[line]\n"
+                           :
+                           : [line] "r"(line)
+                           : "memory");
+    }
+#else
+    USE(start, end);
+#endif
+  }
+
+  virtual void DataSynchronisationBarrier() VIXL_OVERRIDE {
+#ifdef __aarch64__
+    __asm__ __volatile__("   dsb   ish\n" : : : "memory");
+#endif
+  }
+
+  virtual void InstructionSynchronisationBarrier() VIXL_OVERRIDE {
+#ifdef __aarch64__
+    __asm__ __volatile__("   isb\n" : : : "memory");
+#endif
+  }
+};
+
+}  // namespace
+
+
+CacheMaintenanceBackend *CacheMaintenanceBackend::GetHost() {
+  static HostCacheMaintenanceBackend host;
+  return &host;
+}
+
+
+CacheMaintenanceBatch::CacheMaintenanceBatch(CacheMaintenanceBackend *backend)
+    : backend_((backend == NULL) ? CacheMaintenanceBackend::GetHost()
+                                 : backend) {
+  ResetStats();
+}
+
+
+void CacheMaintenanceBatch::ResetStats() {
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+
+void CacheMaintenanceBatch::Add(const void *address, size_t length) {
+  stats_.ranges_added++;
+  if (length == 0) return;
+  uintptr_t start = reinterpret_cast<uintptr_t>(address);
+  ranges_.push_back(std::make_pair(start, start + length));
+}
+
+
+void CacheMaintenanceBatch::Flush() {
+  if (ranges_.empty()) return;
+
+  uintptr_t dsize = backend_->GetDCacheLineSize();
+  uintptr_t isize = backend_->GetICacheLineSize();
+  VIXL_ASSERT(IsPowerOf2(dsize) && IsPowerOf2(isize));
+
+  // Align the ranges to the smaller line size, then merge them. The merged
+  // ranges are sorted, and do not overlap or touch.
+  uintptr_t granule = std::min(dsize, isize);
+  for (size_t i = 0; i < ranges_.size(); i++) {
+    ranges_[i].first = AlignDown(ranges_[i].first, granule);
+    ranges_[i].second = AlignUp(ranges_[i].second, granule);
+  }
+  std::sort(ranges_.begin(), ranges_.end());
+  size_t merged = 0;
+  for (size_t i = 1; i < ranges_.size(); i++) {
+    if (ranges_[i].first <= ranges_[merged].second) {
+      ranges_[merged].second =
+          std::max(ranges_[merged].second, ranges_[i].second);
+    } else {
+      ranges_[++merged] = ranges_[i];
+    }
+  }
+  ranges_.resize(merged + 1);
+
+  // Neighbouring ranges can still share a line of the larger line size, so
+  // start each range after the last line maintained for the previous one.
+  uintptr_t next_line = 0;
+  for (size_t i = 0; i < ranges_.size(); i++) {
+    uintptr_t start = std::max(AlignDown(ranges_[i].first, dsize), next_line);
+    if (start >= ranges_[i].second) continue;
+    backend_->CleanDCacheLines(start, ranges_[i].second);
+    next_line = AlignUp(ranges_[i].second, dsize);
+    stats_.dcache_lines_flushed += (next_line - start) / dsize;
+  }
+  backend_->DataSynchronisationBarrier();
+
+  next_line = 0;
+  for (size_t i = 0; i < ranges_.size(); i++) {
+    uintptr_t start = std::max(AlignDown(ranges_[i].first, isize), next_line);
+    if (start >= ranges_[i].second) continue;
+    backend_->InvalidateICacheLines(start, ranges_[i].second);
+    next_line = AlignUp(ranges_[i].second, isize);
+    stats_.icache_lines_flushed += (next_line - start) / isize;
+  }
+  backend_->DataSynchronisationBarrier();
+  backend_->InstructionSynchronisationBarrier();
+
+  stats_.ranges_flushed += ranges_.size();
+  stats_.epochs++;
+  ranges_.clear();
+}
+
 }  // namespace aarch64
 }  // namespace vixl
@@ -27,6 +27,9 @@
 #ifndef VIXL_CPU_AARCH64_H
 #define VIXL_CPU_AARCH64_H
 
+#include <utility>
+#include <vector>
+
 #include "../cpu-features.h"
 #include "../globals-vixl.h"
 
@@ -204,6 +207,11 @@ class CPU {
   // safely run.
   static void EnsureIAndDCacheCoherency(void *address, size_t length);
 
+  // The I and D cache line sizes, in bytes. These are only meaningful on
+  // AArch64 hosts, once SetUp() has been called.
+  static unsigned GetICacheLineSize() { return icache_line_size_; }
+  static unsigned GetDCacheLineSize() { return dcache_line_size_; }
+
   // Read and interpret the ID registers. This requires
   // CPUFeatures::kIDRegisterEmulation, and therefore cannot be called on
   // non-AArch64 platforms.
@@ -276,6 +284,82 @@ class CPU {
   static unsigned dcache_line_size_;
 };
 
+// The cache maintenance operations used by CacheMaintenanceBatch.
+//
+// GetHost() returns an implementation that uses the host's cache maintenance
+// instructions on AArch64 hosts, and does nothing elsewhere. Other
+// implementations can be used to test or instrument the batching logic.
+class CacheMaintenanceBackend {
+ public:
+  virtual ~CacheMaintenanceBackend() {}
+
+  static CacheMaintenanceBackend* GetHost();
+
+  // Cache line sizes in bytes. These must be powers of two.
+  virtual unsigned GetDCacheLineSize() const = 0;
+  virtual unsigned GetICacheLineSize() const = 0;
+
+  // Clean the D cache lines in [start, end) to the point of unification
+  // (`dc cvau`). `start` is aligned to the D cache line size.
+  virtual void CleanDCacheLines(uintptr_t start, uintptr_t end) = 0;
+
+  // Invalidate the I cache lines in [start, end) to the point of unification
+  // (`ic ivau`). `start` is aligned to the I cache line size.
+  virtual void InvalidateICacheLines(uintptr_t start, uintptr_t end) = 0;
+
+  // `dsb ish`
+  virtual void DataSynchronisationBarrier() = 0;
+
+  // `isb`
+  virtual void InstructionSynchronisationBarrier() = 0;
+};
+
+struct CacheMaintenanceStats {
+  // The number of ranges passed to Add(). Without batching, each would have
+  // needed a call to CPU::EnsureIAndDCacheCoherency().
+  uint64_t ranges_added;
+  // The number of ranges left after merging, for which maintenance was done.
+  uint64_t ranges_flushed;
+  uint64_t dcache_lines_flushed;
+  uint64_t icache_lines_flushed;
+  // The number of (non-empty) epochs, each of which needs one barrier
+  // sequence.
+  uint64_t epochs;
+
+  // The number of CPU::EnsureIAndDCacheCoherency() calls, and so barrier
+  // sequences, that batching avoided.
+  uint64_t GetCallsSaved() const { return ranges_added - epochs; }
+};
+
+// Collects the address ranges of code written during a code-publication epoch,
+// and makes the I and D caches coherent for all of them at once.
+//
+// At the end of an epoch, Flush() aligns the ranges to cache lines and merges
+// those that overlap or are adjacent. It then cleans the D cache for every
+// range, issues one barrier, invalidates the I cache for every range, and
+// issues one final barrier sequence. This is equivalent to calling
+// CPU::EnsureIAndDCacheCoherency() for each range, but each line is only
+// maintained once, and the barriers are only issued once per epoch.
+class CacheMaintenanceBatch {
+ public:
+  // If `backend` is NULL, CacheMaintenanceBackend::GetHost() is used.
+  explicit CacheMaintenanceBatch(CacheMaintenanceBackend *backend = NULL);
+
+  void Add(const void *address, size_t length);
+  void Flush();
+
+  bool IsEmpty() const { return ranges_.empty(); }
+
+  const CacheMaintenanceStats &GetStats() const { return stats_; }
+  void ResetStats();
+
+ private:
+  CacheMaintenanceBackend *backend_;
+  // The [start, end) ranges added since the last Flush().
+  std::vector<std::pair<uintptr_t, uintptr_t> > ranges_;
+  CacheMaintenanceStats stats_;
+};
+
 }  // namespace aarch64
 }  // namespace vixl
 
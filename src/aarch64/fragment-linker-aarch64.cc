@@ -0,0 +1,331 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "fragment-linker-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+CodeFragment::CodeFragment() { masm_.SetRecordRelocations(true); }
+
+
+void CodeFragment::Bind(const char* symbol) {
+  Label label;
+  masm_.Bind(&label);
+  Symbol definition = {symbol, label.GetLocation()};
+  symbols_.push_back(definition);
+}
+
+
+void CodeFragment::AddReference(const char* symbol) {
+  Symbol reference = {symbol, masm_.GetCursorOffset()};
+  references_.push_back(reference);
+}
+
+
+void CodeFragment::B(const char* symbol) {
+  ExactAssemblyScope scope(&masm_, kInstructionSize);
+  AddReference(symbol);
+  masm_.b(kUnresolvedOffset);
+}
+
+
+void CodeFragment::B(Condition cond, const char* symbol) {
+  ExactAssemblyScope scope(&masm_, kInstructionSize);
+  AddReference(symbol);
+  masm_.b(kUnresolvedOffset, cond);
+}
+
+
+void CodeFragment::Bl(const char* symbol) {
+  ExactAssemblyScope scope(&masm_, kInstructionSize);
+  AddReference(symbol);
+  masm_.bl(kUnresolvedOffset);
+}
+
+
+void CodeFragment::Cbz(const Register& rt, const char* symbol) {
+  ExactAssemblyScope scope(&masm_, kInstructionSize);
+  AddReference(symbol);
+  masm_.cbz(rt, kUnresolvedOffset);
+}
+
+
+void CodeFragment::Cbnz(const Register& rt, const char* symbol) {
+  ExactAssemblyScope scope(&masm_, kInstructionSize);
+  AddReference(symbol);
+  masm_.cbnz(rt, kUnresolvedOffset);
+}
+
+
+void CodeFragment::Tbz(const Register& rt,
+                       unsigned bit_pos,
+                       const char* symbol) {
+  ExactAssemblyScope scope(&masm_, kInstructionSize);
+  AddReference(symbol);
+  masm_.tbz(rt, bit_pos, kUnresolvedOffset);
+}
+
+
+void CodeFragment::Tbnz(const Register& rt,
+                        unsigned bit_pos,
+                        const char* symbol) {
+  ExactAssemblyScope scope(&masm_, kInstructionSize);
+  AddReference(symbol);
+  masm_.tbnz(rt, bit_pos, kUnresolvedOffset);
+}
+
+
+void FragmentLinker::AddFragment(const CodeFragment* fragment) {
+  VIXL_ASSERT(!fragment->GetMacroAssembler()->GetBuffer().IsDirty());
+  fragments_.push_back(fragment);
+}
+
+
+bool FragmentLinker::HasSymbol(const char* name) const {
+  return symbols_.find(name) != symbols_.end();
+}
+
+
+ptrdiff_t FragmentLinker::GetSymbolOffset(const char* name) const {
+  VIXL_ASSERT(HasSymbol(name));
+  return LookUpSymbol(name);
+}
+
+
+ptrdiff_t FragmentLinker::LookUpSymbol(const std::string& name) const {
+  std::map<std::string, ptrdiff_t>::const_iterator it = symbols_.find(name);
+  if (it == symbols_.end()) {
+    std::string message = "Undefined symbol: " + name + "\n";
+    VIXL_ABORT_WITH_MSG(message.c_str());
+  }
+  return it->second;
+}
+
+
+ptrdiff_t FragmentLinker::LayOut(ptrdiff_t base,
+                                 std::vector<Site>* sites,
+                                 std::vector<ptrdiff_t>* offsets) {
+  ptrdiff_t offset = base;
+  symbols_.clear();
+  size_t first_site = 0;
+  for (size_t i = 0; i < fragments_.size(); i++) {
+    const CodeFragment* fragment = fragments_[i];
+    size_t end_site = first_site;
+    size_t veneers_before = 0;
+    while ((end_site < sites->size()) && ((*sites)[end_site].fragment == i)) {
+      if ((*sites)[end_site].veneer == kVeneerBefore) veneers_before++;
+      end_site++;
+    }
+
+    // Any padding goes before the veneers, so that they are as close as
+    // possible to the fragment.
+    offset = AlignUp(offset + veneers_before * kVeneerSize, kFragmentAlignment);
+    (*offsets)[i] = offset;
+    ptrdiff_t veneer_offset = offset - veneers_before * kVeneerSize;
+    for (size_t j = 0; j < fragment->symbols_.size(); j++) {
+      const CodeFragment::Symbol& symbol = fragment->symbols_[j];
+      bool inserted =
+          symbols_.insert(std::make_pair(symbol.name, offset + symbol.offset))
+              .second;
+      VIXL_CHECK(inserted);
+    }
+    offset += fragment->GetSizeOfCodeGenerated();
+
+    for (size_t j = first_site; j < end_site; j++) {
+      Site* site = &(*sites)[j];
+      if (site->veneer == kVeneerBefore) {
+        site->veneer_offset = veneer_offset;
+        veneer_offset += kVeneerSize;
+      } else if (site->veneer == kVeneerAfter) {
+        site->veneer_offset = offset;
+        offset += kVeneerSize;
+      }
+    }
+    first_site = end_site;
+  }
+  return offset;
+}
+
+
+bool FragmentLinker::CanReach(const Instruction* branch,
+                              ptrdiff_t from,
+                              ptrdiff_t to) {
+  return Instruction::IsValidImmPCOffset(branch->GetBranchType(),
+                                         (to - from) / kInstructionSize);
+}
+
+
+void FragmentLinker::Link(CodeBuffer* buffer) {
+  std::vector<Site> sites;
+  for (size_t i = 0; i < fragments_.size(); i++) {
+    const std::vector<CodeFragment::Symbol>& references =
+        fragments_[i]->references_;
+    for (size_t j = 0; j < references.size(); j++) {
+      Site site = {i, &references[j], kNoVeneer, 0};
+      sites.push_back(site);
+    }
+  }
+
+  // Veneers move the code around them, and so can put other references, or
+  // other veneers, out of range. Repeat the layout until every reference can
+  // reach its target or its veneer. A site only ever moves from kNoVeneer to
+  // kVeneerAfter to kVeneerBefore, so this terminates.
+  ptrdiff_t base = buffer->GetCursorOffset();
+  std::vector<ptrdiff_t> offsets(fragments_.size());
+  ptrdiff_t end = base;
+  bool changed = true;
+  while (changed) {
+    end = LayOut(base, &sites, &offsets);
+    changed = false;
+    for (size_t i = 0; i < sites.size(); i++) {
+      Site* site = &sites[i];
+      const CodeFragment* fragment = fragments_[site->fragment];
+      const Instruction* branch =
+          fragment->GetMacroAssembler()
+              ->GetBuffer()
+              .GetOffsetAddress<const Instruction*>(site->reference->offset);
+      ptrdiff_t site_offset = offsets[site->fragment] + site->reference->offset;
+      switch (site->veneer) {
+        case kNoVeneer: {
+          ptrdiff_t target = LookUpSymbol(site->reference->name);
+          if (CanReach(branch, site_offset, target)) continue;
+          // Prefer a veneer after the fragment. Its exact position depends on
+          // the other veneers, so it is checked again on the next iteration.
+          ptrdiff_t fragment_end =
+              offsets[site->fragment] + fragment->GetSizeOfCodeGenerated();
+          site->veneer = CanReach(branch, site_offset, fragment_end)
+                             ? kVeneerAfter
+                             : kVeneerBefore;
+          break;
+        }
+        case kVeneerAfter:
+          if (CanReach(branch, site_offset, site->veneer_offset)) continue;
+          site->veneer = kVeneerBefore;
+          break;
+        case kVeneerBefore:
+          if (CanReach(branch, site_offset, site->veneer_offset)) continue;
+          VIXL_ABORT_WITH_MSG(
+              "A branch is out of range of both ends of its fragment.\n");
+      }
+      changed = true;
+    }
+  }
+
+  // Emit the fragments, each surrounded by its veneers.
+  buffer->EnsureSpaceFor(static_cast<size_t>(end - base));
+  veneer_count_ = 0;
+  size_t first_site = 0;
+  for (size_t i = 0; i < fragments_.size(); i++) {
+    size_t end_site = first_site;
+    while ((end_site < sites.size()) && (sites[end_site].fragment == i)) {
+      end_site++;
+    }
+    auto emit_veneers = [&](VeneerPlacement placement) {
+      for (size_t j = first_site; j < end_site; j++) {
+        const Site& site = sites[j];
+        if (site.veneer != placement) continue;
+        VIXL_ASSERT(buffer->GetCursorOffset() <= site.veneer_offset);
+        buffer->EmitZeroedBytes(
+            static_cast<int>(site.veneer_offset - buffer->GetCursorOffset()));
+        EmitVeneer(buffer,
+                   LookUpSymbol(site.reference->name) - site.veneer_offset);
+        veneer_count_++;
+      }
+    };
+
+    emit_veneers(kVeneerBefore);
+    const CodeBuffer& code = fragments_[i]->GetMacroAssembler()->GetBuffer();
+    VIXL_ASSERT(buffer->GetCursorOffset() <= offsets[i]);
+    buffer->EmitZeroedBytes(
+        static_cast<int>(offsets[i] - buffer->GetCursorOffset()));
+    buffer->EmitData(code.GetStartAddress<const void*>(),
+                     code.GetSizeInBytes());
+    emit_veneers(kVeneerAfter);
+    first_site = end_site;
+  }
+
+  // Resolve the references now that the buffer will not move again.
+  for (size_t i = 0; i < sites.size(); i++) {
+    const Site& site = sites[i];
+    ptrdiff_t site_offset = offsets[site.fragment] + site.reference->offset;
+    ptrdiff_t target_offset = (site.veneer != kNoVeneer)
+                                  ? site.veneer_offset
+                                  : LookUpSymbol(site.reference->name);
+    Instruction* branch = buffer->GetOffsetAddress<Instruction*>(site_offset);
+    VIXL_CHECK(CanReach(branch, site_offset, target_offset));
+    branch->SetImmPCOffsetTarget(
+        buffer->GetOffsetAddress<Instruction*>(target_offset));
+  }
+
+  // Combine the fragments' relocations, and apply them so that the linked
+  // code can be run from the buffer.
+  relocations_.clear();
+  for (size_t i = 0; i < fragments_.size(); i++) {
+    const std::vector<Relocation>& relocations =
+        fragments_[i]->GetMacroAssembler()->GetRelocations();
+    for (size_t j = 0; j < relocations.size(); j++) {
+      Relocation relocation = relocations[j];
+      relocation.offset += offsets[i];
+      if (relocation.kind == Relocation::kAdrpInternal) {
+        VIXL_ASSERT(relocation.target != Relocation::kUnresolvedTarget);
+        relocation.target += offsets[i];
+      }
+      relocations_.push_back(relocation);
+    }
+  }
+  if (!relocations_.empty()) {
+    RelocateCode(buffer->GetStartAddress<void*>(),
+                 buffer->GetExecutableStartAddress<uintptr_t>(),
+                 buffer->GetSizeInBytes(),
+                 relocations_);
+  }
+}
+
+
+void FragmentLinker::EmitVeneer(CodeBuffer* buffer, int64_t offset_to_target) {
+  // The target is stored as an offset from the veneer, so that the veneer
+  // works from any address.
+  byte veneer[kVeneerSize];
+  Assembler assm(veneer, sizeof(veneer));
+  {
+    CodeBufferCheckScope scope(&assm,
+                               kVeneerSize,
+                               CodeBufferCheckScope::kReserveBufferSpace,
+                               CodeBufferCheckScope::kExactSize);
+    assm.adr(ip1, INT64_C(0));
+    // Load the offset, three instructions ahead.
+    assm.ldr(ip0, INT64_C(3));
+    assm.add(ip0, ip0, ip1);
+    assm.br(ip0);
+    assm.dc64(offset_to_target);
+  }
+  assm.FinalizeCode();
+  buffer->EmitData(veneer, sizeof(veneer));
+}
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,180 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VIXL_AARCH64_FRAGMENT_LINKER_AARCH64_H_
+#define VIXL_AARCH64_FRAGMENT_LINKER_AARCH64_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../code-buffer-vixl.h"
+#include "../globals-vixl.h"
+
+#include "macro-assembler-aarch64.h"
+#include "relocation-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// A piece of a larger module, generated independently of the rest of the
+// module. Fragments share no state, so several fragments can be generated at
+// once on different threads, and then combined by a FragmentLinker.
+//
+// Code is generated with the fragment's MacroAssembler as usual. Labels cannot
+// be shared between fragments, so code in one fragment refers to code in
+// another through named symbols: Bind() defines a symbol, and the branch
+// helpers below emit a branch to a symbol, to be resolved by the linker.
+//
+// The MacroAssembler records relocations, so fragments may use any code that
+// can be relocated (see Assembler::SetRecordRelocations()).
+class CodeFragment {
+ public:
+  CodeFragment();
+
+  MacroAssembler* GetMacroAssembler() { return &masm_; }
+  const MacroAssembler* GetMacroAssembler() const { return &masm_; }
+
+  // Define `symbol` at the current position.
+  void Bind(const char* symbol);
+
+  // Branch to `symbol`, which may be defined in any fragment.
+  void B(const char* symbol);
+  void B(Condition cond, const char* symbol);
+  void Bl(const char* symbol);
+  void Cbz(const Register& rt, const char* symbol);
+  void Cbnz(const Register& rt, const char* symbol);
+  void Tbz(const Register& rt, unsigned bit_pos, const char* symbol);
+  void Tbnz(const Register& rt, unsigned bit_pos, const char* symbol);
+
+  void FinalizeCode() { masm_.FinalizeCode(); }
+
+  size_t GetSizeOfCodeGenerated() const {
+    return masm_.GetSizeOfCodeGenerated();
+  }
+
+ private:
+  friend class FragmentLinker;
+
+  struct Symbol {
+    std::string name;
+    ptrdiff_t offset;
+  };
+
+  // The placeholder branch offset emitted for a reference.
+  static const int64_t kUnresolvedOffset = 0;
+
+  void AddReference(const char* symbol);
+
+  MacroAssembler masm_;
+  std::vector<Symbol> symbols_;
+  // Each reference is a branch at `offset` to the symbol `name`.
+  std::vector<Symbol> references_;
+};
+
+
+// Combine CodeFragments into a single piece of code.
+//
+// Link() concatenates the fragments into a CodeBuffer, and resolves the
+// branches between them. A branch whose symbol is out of its range is
+// redirected to a veneer, which can reach any address. The veneers are
+// position-independent, and clobber ip0 and ip1, as permitted by the procedure
+// call standard.
+//
+// Fragments are never split, so veneers are emitted directly after the
+// fragment that contains the branch or, if the branch cannot reach that,
+// directly before it. This limits the size of fragments that contain
+// branches with a short range: a tbz or tbnz (+/-32KB), or a cbz, cbnz or
+// b.cond (+/-1MB), must be within range of the start or the end of its
+// fragment. Link() aborts if a branch cannot reach its veneer.
+//
+// Each fragment keeps its own literal pool. Pools are emitted within the
+// fragments that use them, and are addressed PC-relatively, so concatenation
+// leaves them in range.
+//
+// The relocations recorded by the fragments are combined, so that the linked
+// code can be moved (for example, with CodeSpace::Commit()).
+class FragmentLinker {
+ public:
+  // Fragments are aligned to this in the linked code.
+  static const size_t kFragmentAlignment = 16;
+  static const size_t kVeneerSize = 4 * kInstructionSize + sizeof(uint64_t);
+
+  FragmentLinker() : veneer_count_(0) {}
+
+  // Add a fragment, which must have been finalised. The fragment must stay
+  // alive until Link() has been called. Fragments are linked in the order in
+  // which they are added.
+  void AddFragment(const CodeFragment* fragment);
+
+  // Append the linked code to `buffer`. Every referenced symbol must be
+  // defined, exactly once, by one of the fragments. Afterwards, the buffer
+  // must be finalised (with CodeBuffer::SetClean()) as usual.
+  void Link(CodeBuffer* buffer);
+
+  // The following can be used after Link(). All offsets are from the start of
+  // `buffer`.
+
+  bool HasSymbol(const char* name) const;
+  ptrdiff_t GetSymbolOffset(const char* name) const;
+
+  const std::vector<Relocation>& GetRelocations() const {
+    return relocations_;
+  }
+
+  size_t GetVeneerCount() const { return veneer_count_; }
+
+ private:
+  enum VeneerPlacement { kNoVeneer, kVeneerAfter, kVeneerBefore };
+
+  // A reference that might need a veneer. Sites are sorted by fragment.
+  struct Site {
+    size_t fragment;
+    const CodeFragment::Symbol* reference;
+    VeneerPlacement veneer;
+    ptrdiff_t veneer_offset;
+  };
+
+  ptrdiff_t LookUpSymbol(const std::string& name) const;
+  // Place the fragments and veneers, and define the symbols. Returns the offset
+  // of the end of the linked code.
+  ptrdiff_t LayOut(ptrdiff_t base,
+                   std::vector<Site>* sites,
+                   std::vector<ptrdiff_t>* offsets);
+  // Return true if `branch`, at `from`, can reach `to`.
+  static bool CanReach(const Instruction* branch, ptrdiff_t from, ptrdiff_t to);
+  static void EmitVeneer(CodeBuffer* buffer, int64_t offset_to_target);
+
+  std::vector<const CodeFragment*> fragments_;
+  std::map<std::string, ptrdiff_t> symbols_;
+  std::vector<Relocation> relocations_;
+  size_t veneer_count_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_FRAGMENT_LINKER_AARCH64_H_
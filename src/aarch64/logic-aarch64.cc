@@ -26,6 +26,7 @@
 
 #ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
 
+#include <algorithm>
 #include <cmath>
 
 #include "simulator-aarch64.h"
@@ -167,12 +168,64 @@ SimFloat16 Simulator::UFixedToFloat16(uint64_t src,
 }
 
 
-void Simulator::ld1(VectorFormat vform, LogicVRegister dst, uint64_t addr) {
-  dst.ClearForWrite(vform);
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    LoadLane(dst, vform, i, addr);
-    addr += LaneSizeInBytesFromFormat(vform);
+void Simulator::LoadInterleaved(VectorFormat vform,
+                                LogicVRegister* dst,
+                                int reg_count,
+                                uint64_t addr) {
+  VIXL_ASSERT(!IsSVEFormat(vform));
+  VIXL_ASSERT((reg_count >= 1) && (reg_count <= 4));
+  int esize = LaneSizeInBytesFromFormat(vform);
+  int lane_count = LaneCountFromFormat(vform);
+  int reg_size = esize * lane_count;
+
+  uint8_t data[4 * kQRegSizeInBytes];
+  MemReadBlock(addr, data, reg_size * reg_count, MemoryTraceRecord::kVector);
+
+  for (int r = 0; r < reg_count; r++) {
+    uint8_t lanes[kQRegSizeInBytes];
+    const uint8_t* src = data + (r * reg_size);
+    if (reg_count > 1) {
+      // De-interleave the structures.
+      for (int i = 0; i < lane_count; i++) {
+        memcpy(&lanes[i * esize], &data[((i * reg_count) + r) * esize], esize);
+      }
+      src = lanes;
+    }
+    dst[r].ClearForWrite(vform);
+    dst[r].WriteLanes(vform, src, reg_size);
+  }
+}
+
+
+void Simulator::StoreInterleaved(VectorFormat vform,
+                                 const LogicVRegister* src,
+                                 int reg_count,
+                                 uint64_t addr) {
+  VIXL_ASSERT(!IsSVEFormat(vform));
+  VIXL_ASSERT((reg_count >= 1) && (reg_count <= 4));
+  int esize = LaneSizeInBytesFromFormat(vform);
+  int lane_count = LaneCountFromFormat(vform);
+  int reg_size = esize * lane_count;
+
+  uint8_t data[4 * kQRegSizeInBytes];
+  for (int r = 0; r < reg_count; r++) {
+    if (reg_count == 1) {
+      src[r].ReadLanes(vform, data, reg_size);
+    } else {
+      // Interleave the structures.
+      uint8_t lanes[kQRegSizeInBytes];
+      src[r].ReadLanes(vform, lanes, reg_size);
+      for (int i = 0; i < lane_count; i++) {
+        memcpy(&data[((i * reg_count) + r) * esize], &lanes[i * esize], esize);
+      }
+    }
   }
+  MemWriteBlock(addr, data, reg_size * reg_count, MemoryTraceRecord::kVector);
+}
+
+
+void Simulator::ld1(VectorFormat vform, LogicVRegister dst, uint64_t addr) {
+  LoadInterleaved(vform, &dst, 1, addr);
 }
 
 
@@ -210,16 +263,8 @@ void Simulator::ld2(VectorFormat vform,
                     LogicVRegister dst1,
                     LogicVRegister dst2,
                     uint64_t addr1) {
-  dst1.ClearForWrite(vform);
-  dst2.ClearForWrite(vform);
-  int esize = LaneSizeInBytesFromFormat(vform);
-  uint64_t addr2 = addr1 + esize;
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    LoadLane(dst1, vform, i, addr1);
-    LoadLane(dst2, vform, i, addr2);
-    addr1 += 2 * esize;
-    addr2 += 2 * esize;
-  }
+  LogicVRegister dst[] = {dst1, dst2};
+  LoadInterleaved(vform, dst, 2, addr1);
 }
 
 
@@ -255,20 +300,8 @@ void Simulator::ld3(VectorFormat vform,
                     LogicVRegister dst2,
                     LogicVRegister dst3,
                     uint64_t addr1) {
-  dst1.ClearForWrite(vform);
-  dst2.ClearForWrite(vform);
-  dst3.ClearForWrite(vform);
-  int esize = LaneSizeInBytesFromFormat(vform);
-  uint64_t addr2 = addr1 + esize;
-  uint64_t addr3 = addr2 + esize;
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    LoadLane(dst1, vform, i, addr1);
-    LoadLane(dst2, vform, i, addr2);
-    LoadLane(dst3, vform, i, addr3);
-    addr1 += 3 * esize;
-    addr2 += 3 * esize;
-    addr3 += 3 * esize;
-  }
+  LogicVRegister dst[] = {dst1, dst2, dst3};
+  LoadInterleaved(vform, dst, 3, addr1);
 }
 
 
@@ -313,24 +346,8 @@ void Simulator::ld4(VectorFormat vform,
                     LogicVRegister dst3,
                     LogicVRegister dst4,
                     uint64_t addr1) {
-  dst1.ClearForWrite(vform);
-  dst2.ClearForWrite(vform);
-  dst3.ClearForWrite(vform);
-  dst4.ClearForWrite(vform);
-  int esize = LaneSizeInBytesFromFormat(vform);
-  uint64_t addr2 = addr1 + esize;
-  uint64_t addr3 = addr2 + esize;
-  uint64_t addr4 = addr3 + esize;
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    LoadLane(dst1, vform, i, addr1);
-    LoadLane(dst2, vform, i, addr2);
-    LoadLane(dst3, vform, i, addr3);
-    LoadLane(dst4, vform, i, addr4);
-    addr1 += 4 * esize;
-    addr2 += 4 * esize;
-    addr3 += 4 * esize;
-    addr4 += 4 * esize;
-  }
+  LogicVRegister dst[] = {dst1, dst2, dst3, dst4};
+  LoadInterleaved(vform, dst, 4, addr1);
 }
 
 
@@ -378,10 +395,7 @@ void Simulator::ld4r(VectorFormat vform,
 
 
 void Simulator::st1(VectorFormat vform, LogicVRegister src, uint64_t addr) {
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    StoreLane(src, vform, i, addr);
-    addr += LaneSizeInBytesFromFormat(vform);
-  }
+  StoreInterleaved(vform, &src, 1, addr);
 }
 
 
@@ -397,14 +411,8 @@ void Simulator::st2(VectorFormat vform,
                     LogicVRegister src,
                     LogicVRegister src2,
                     uint64_t addr) {
-  int esize = LaneSizeInBytesFromFormat(vform);
-  uint64_t addr2 = addr + esize;
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    StoreLane(src, vform, i, addr);
-    StoreLane(src2, vform, i, addr2);
-    addr += 2 * esize;
-    addr2 += 2 * esize;
-  }
+  LogicVRegister srcs[] = {src, src2};
+  StoreInterleaved(vform, srcs, 2, addr);
 }
 
 
@@ -424,17 +432,8 @@ void Simulator::st3(VectorFormat vform,
                     LogicVRegister src2,
                     LogicVRegister src3,
                     uint64_t addr) {
-  int esize = LaneSizeInBytesFromFormat(vform);
-  uint64_t addr2 = addr + esize;
-  uint64_t addr3 = addr2 + esize;
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    StoreLane(src, vform, i, addr);
-    StoreLane(src2, vform, i, addr2);
-    StoreLane(src3, vform, i, addr3);
-    addr += 3 * esize;
-    addr2 += 3 * esize;
-    addr3 += 3 * esize;
-  }
+  LogicVRegister srcs[] = {src, src2, src3};
+  StoreInterleaved(vform, srcs, 3, addr);
 }
 
 
@@ -457,20 +456,8 @@ void Simulator::st4(VectorFormat vform,
                     LogicVRegister src3,
                     LogicVRegister src4,
                     uint64_t addr) {
-  int esize = LaneSizeInBytesFromFormat(vform);
-  uint64_t addr2 = addr + esize;
-  uint64_t addr3 = addr2 + esize;
-  uint64_t addr4 = addr3 + esize;
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    StoreLane(src, vform, i, addr);
-    StoreLane(src2, vform, i, addr2);
-    StoreLane(src3, vform, i, addr3);
-    StoreLane(src4, vform, i, addr4);
-    addr += 4 * esize;
-    addr2 += 4 * esize;
-    addr3 += 4 * esize;
-    addr4 += 4 * esize;
-  }
+  LogicVRegister srcs[] = {src, src2, src3, src4};
+  StoreInterleaved(vform, srcs, 4, addr);
 }
 
 
@@ -1822,6 +1809,39 @@ LogicVRegister Simulator::sel(VectorFormat vform,
                               const SimPRegister& pg,
                               const LogicVRegister& src1,
                               const LogicVRegister& src2) {
+  if (IsSVEFormat(vform)) {
+    // Start with `src2`, then copy in the active lanes from `src1`, skipping
+    // over wholly-inactive blocks of lanes.
+    int size = GetVectorLengthInBytes();
+    int lane_size = LaneSizeInBytesFromFormat(vform);
+    uint8_t values1[kZRegMaxSizeInBytes];
+    uint8_t result[kZRegMaxSizeInBytes];
+    src1.ReadLanes(values1, size);
+    src2.ReadLanes(result, size);
+    const uint8_t* pg_bytes = pg.GetBytes();
+    uint64_t lane_mask = LogicPRegister::GetLaneMask(vform);
+    // Each predicate bit governs one byte of the vector, so each 64-bit word
+    // of the predicate governs a 64-byte block.
+    const int block_size = kXRegSize;
+    for (int base = 0; base < size; base += block_size) {
+      int bytes = std::min(size - base, block_size);
+      uint64_t active = 0;
+      memcpy(&active, &pg_bytes[base / kBitsPerByte], bytes / kBitsPerByte);
+      active &= lane_mask;
+      if (active == (lane_mask & GetUintMask(bytes))) {
+        memcpy(&result[base], &values1[base], bytes);
+      } else {
+        while (active != 0) {
+          int offset = base + CountTrailingZeros(active);
+          memcpy(&result[offset], &values1[offset], lane_size);
+          active &= active - 1;
+        }
+      }
+    }
+    dst.WriteLanes(result, size);
+    return dst;
+  }
+
   int p_reg_bits_per_lane =
       LaneSizeInBitsFromFormat(vform) / kZRegBitsPerPRegBit;
   for (int lane = 0; lane < LaneCountFromFormat(vform); lane++) {
@@ -6212,10 +6232,7 @@ LogicPRegister Simulator::ptrue(VectorFormat vform,
                                 LogicPRegister dst,
                                 int pattern) {
   int count = GetPredicateConstraintLaneCount(vform, pattern);
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    dst.SetActive(vform, i, i < count);
-  }
-  return dst;
+  return SetLeadingActiveLanes(vform, dst, count);
 }
 
 LogicPRegister Simulator::pnext(VectorFormat vform,
@@ -6873,37 +6890,139 @@ LogicVRegister Simulator::asrd(VectorFormat vform,
   return dst;
 }
 
+// Lane-wise operations on whole SVE registers. The lanes are read and written
+// in bulk, so that the loop itself doesn't need to handle the register
+// representation.
+template <typename T, typename Op>
+static void SVELanewiseHelper(unsigned vl,
+                              LogicVRegister zd,
+                              const LogicVRegister& zn,
+                              const LogicVRegister& zm,
+                              Op op) {
+  const int kMaxLaneCount = kZRegMaxSize / (sizeof(T) * kBitsPerByte);
+  int lane_count = vl / (sizeof(T) * kBitsPerByte);
+  VIXL_ASSERT(lane_count <= kMaxLaneCount);
+  T n[kMaxLaneCount];
+  T m[kMaxLaneCount];
+  T d[kMaxLaneCount];
+  zn.ReadLanes(n, lane_count);
+  zm.ReadLanes(m, lane_count);
+  for (int i = 0; i < lane_count; i++) d[i] = op(n[i], m[i]);
+  zd.WriteLanes(d, lane_count);
+}
+
+template <typename Op>
+static void SVELanewiseHelper(VectorFormat vform,
+                              unsigned vl,
+                              LogicVRegister zd,
+                              const LogicVRegister& zn,
+                              const LogicVRegister& zm,
+                              Op op) {
+  VIXL_ASSERT(IsSVEFormat(vform));
+  switch (LaneSizeInBitsFromFormat(vform)) {
+    case kBRegSize:
+      SVELanewiseHelper<uint8_t>(vl, zd, zn, zm, op);
+      break;
+    case kHRegSize:
+      SVELanewiseHelper<uint16_t>(vl, zd, zn, zm, op);
+      break;
+    case kSRegSize:
+      SVELanewiseHelper<uint32_t>(vl, zd, zn, zm, op);
+      break;
+    case kDRegSize:
+      SVELanewiseHelper<uint64_t>(vl, zd, zn, zm, op);
+      break;
+    default:
+      VIXL_UNREACHABLE();
+  }
+}
+
+// The operations are applied to unsigned lanes, so they wrap on overflow.
+struct SVELanewiseAdd {
+  template <typename T>
+  T operator()(T op1, T op2) const {
+    return static_cast<T>(op1 + op2);
+  }
+};
+
+struct SVELanewiseSub {
+  template <typename T>
+  T operator()(T op1, T op2) const {
+    return static_cast<T>(op1 - op2);
+  }
+};
+
+struct SVELanewiseAnd {
+  template <typename T>
+  T operator()(T op1, T op2) const {
+    return op1 & op2;
+  }
+};
+
+struct SVELanewiseBic {
+  template <typename T>
+  T operator()(T op1, T op2) const {
+    return op1 & ~op2;
+  }
+};
+
+struct SVELanewiseEor {
+  template <typename T>
+  T operator()(T op1, T op2) const {
+    return op1 ^ op2;
+  }
+};
+
+struct SVELanewiseOrr {
+  template <typename T>
+  T operator()(T op1, T op2) const {
+    return op1 | op2;
+  }
+};
+
+LogicVRegister Simulator::SVEAddSubUnpredicatedHelper(
+    AddSubOp op,
+    VectorFormat vform,
+    LogicVRegister zd,
+    const LogicVRegister& zn,
+    const LogicVRegister& zm) {
+  unsigned vl = GetVectorLengthInBits();
+  switch (op) {
+    case ADD:
+      SVELanewiseHelper(vform, vl, zd, zn, zm, SVELanewiseAdd());
+      break;
+    case SUB:
+      SVELanewiseHelper(vform, vl, zd, zn, zm, SVELanewiseSub());
+      break;
+    default:
+      VIXL_UNIMPLEMENTED();
+  }
+  return zd;
+}
+
 LogicVRegister Simulator::SVEBitwiseLogicalUnpredicatedHelper(
     LogicalOp logical_op,
     VectorFormat vform,
     LogicVRegister zd,
     const LogicVRegister& zn,
     const LogicVRegister& zm) {
-  VIXL_ASSERT(IsSVEFormat(vform));
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    uint64_t op1 = zn.Uint(vform, i);
-    uint64_t op2 = zm.Uint(vform, i);
-    uint64_t result;
-    switch (logical_op) {
-      case AND:
-        result = op1 & op2;
-        break;
-      case BIC:
-        result = op1 & ~op2;
-        break;
-      case EOR:
-        result = op1 ^ op2;
-        break;
-      case ORR:
-        result = op1 | op2;
-        break;
-      default:
-        result = 0;
-        VIXL_UNIMPLEMENTED();
-    }
-    zd.SetUint(vform, i, result);
+  unsigned vl = GetVectorLengthInBits();
+  switch (logical_op) {
+    case AND:
+      SVELanewiseHelper(vform, vl, zd, zn, zm, SVELanewiseAnd());
+      break;
+    case BIC:
+      SVELanewiseHelper(vform, vl, zd, zn, zm, SVELanewiseBic());
+      break;
+    case EOR:
+      SVELanewiseHelper(vform, vl, zd, zn, zm, SVELanewiseEor());
+      break;
+    case ORR:
+      SVELanewiseHelper(vform, vl, zd, zn, zm, SVELanewiseOrr());
+      break;
+    default:
+      VIXL_UNIMPLEMENTED();
   }
-
   return zd;
 }
 
@@ -7014,12 +7133,24 @@ void Simulator::SVEStructuredStoreHelper(VectorFormat vform,
       SVEFormatFromLaneSizeInBytesLog2(msize_in_bytes_log2);
   int unpack_shift = esize_in_bytes_log2 - msize_in_bytes_log2;
 
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    if (!pg.IsActive(vform, i)) continue;
+  int flags = MemoryTraceRecord::kVector;
+  if (addr.IsScatterGather()) flags |= MemoryTraceRecord::kGather;
 
-    for (int r = 0; r < reg_count; r++) {
-      uint64_t element_address = addr.GetElementAddress(i, r);
-      StoreLane(zt[r], unpack_vform, i << unpack_shift, element_address);
+  bool done = addr.IsContiguous()
+                  ? SVEContiguousStoreHelper(vform, pg, zt, addr, flags)
+                  : SVEScatterStoreHelper(vform, pg, zt[0], addr);
+  if (!done) {
+    for (int i = 0; i < LaneCountFromFormat(vform); i++) {
+      if (!pg.IsActive(vform, i)) continue;
+
+      for (int r = 0; r < reg_count; r++) {
+        uint64_t element_address = addr.GetElementAddress(i, r);
+        StoreLane(zt[r],
+                  unpack_vform,
+                  i << unpack_shift,
+                  element_address,
+                  flags);
+      }
     }
   }
 
@@ -7043,6 +7174,282 @@ void Simulator::SVEStructuredStoreHelper(VectorFormat vform,
   }
 }
 
+bool Simulator::SVEContiguousStoreHelper(VectorFormat vform,
+                                         const LogicPRegister& pg,
+                                         const LogicVRegister* zt,
+                                         const LogicSVEAddressVector& addr,
+                                         int flags) {
+  VIXL_ASSERT(addr.IsContiguous());
+  int first = GetFirstActive(vform, pg);
+  if (first < 0) return true;
+  int last = GetLastActive(vform, pg);
+
+  int esize = LaneSizeInBytesFromFormat(vform);
+  int msize = addr.GetMsizeInBytes();
+  int reg_count = addr.GetRegCount();
+  int struct_size = msize * reg_count;
+  uint64_t start = addr.GetStructAddress(first);
+  if (memory_.IsAccessInGuardRegion(start, (last - first + 1) * struct_size)) {
+    return false;
+  }
+
+  // Build the interleaved structures in memory order. For unpacked forms,
+  // each element is the low-order part of its lane.
+  int lane_count = LaneCountFromFormat(vform);
+  uint8_t data[4 * kZRegMaxSizeInBytes];
+  for (int r = 0; r < reg_count; r++) {
+    uint8_t lanes[kZRegMaxSizeInBytes];
+    zt[r].ReadLanes(lanes, lane_count * esize);
+    if ((reg_count == 1) && (esize == msize)) {
+      memcpy(data, lanes, lane_count * esize);
+    } else {
+      for (int i = first; i <= last; i++) {
+        memcpy(&data[(i * struct_size) + (r * msize)],
+               &lanes[i * esize],
+               msize);
+      }
+    }
+  }
+
+  // Write each run of active structures as a single block.
+  int i = first;
+  while (i <= last) {
+    if (!pg.IsActive(vform, i)) {
+      i++;
+      continue;
+    }
+    int run_start = i;
+    while ((i <= last) && pg.IsActive(vform, i)) i++;
+    MemWriteBlock(addr.GetStructAddress(run_start),
+                  &data[run_start * struct_size],
+                  (i - run_start) * struct_size,
+                  flags);
+  }
+  return true;
+}
+
+bool Simulator::SVEContiguousLoadHelper(VectorFormat vform,
+                                        const LogicPRegister& pg,
+                                        LogicVRegister* zt,
+                                        const LogicSVEAddressVector& addr,
+                                        bool is_signed,
+                                        int flags) {
+  VIXL_ASSERT(addr.IsContiguous());
+  int esize = LaneSizeInBytesFromFormat(vform);
+  int msize = addr.GetMsizeInBytes();
+  int reg_count = addr.GetRegCount();
+  int struct_size = msize * reg_count;
+  int lane_count = LaneCountFromFormat(vform);
+
+  // Read each run of active structures as a single block. Inactive
+  // structures are not accessed, so they are never seen by watchpoints, the
+  // memory trace or guest memory.
+  uint8_t data[4 * kZRegMaxSizeInBytes];
+  int first = GetFirstActive(vform, pg);
+  if (first >= 0) {
+    int last = GetLastActive(vform, pg);
+    uint64_t start = addr.GetStructAddress(first);
+    size_t size = (last - first + 1) * struct_size;
+    if (memory_.IsAccessInGuardRegion(start, size)) return false;
+    int i = first;
+    while (i <= last) {
+      if (!pg.IsActive(vform, i)) {
+        i++;
+        continue;
+      }
+      int run_start = i;
+      while ((i <= last) && pg.IsActive(vform, i)) i++;
+      MemReadBlock(addr.GetStructAddress(run_start),
+                   &data[run_start * struct_size],
+                   (i - run_start) * struct_size,
+                   flags);
+    }
+  }
+
+  bool all_active = (first == 0) && (CountActiveLanes(vform, pg) == lane_count);
+  for (int r = 0; r < reg_count; r++) {
+    uint8_t lanes[kZRegMaxSizeInBytes];
+    if (all_active && (reg_count == 1) && (esize == msize)) {
+      memcpy(lanes, data, lane_count * esize);
+    } else {
+      // De-interleave, extend and mask the elements.
+      int msb = (msize * kBitsPerByte) - 1;
+      for (int i = 0; i < lane_count; i++) {
+        uint64_t value = 0;
+        if (pg.IsActive(vform, i)) {
+          memcpy(&value, &data[(i * struct_size) + (r * msize)], msize);
+          if (is_signed) value = ExtractSignedBitfield64(msb, 0, value);
+        }
+        memcpy(&lanes[i * esize], &value, esize);
+      }
+    }
+    zt[r].WriteLanes(lanes, lane_count * esize);
+  }
+  return true;
+}
+
+int Simulator::GetGatherScatterAddresses(VectorFormat vform,
+                                         const LogicPRegister& pg,
+                                         const LogicSVEAddressVector& addr,
+                                         uint64_t* addresses,
+                                         int* lanes,
+                                         int64_t* stride) {
+  VIXL_ASSERT(addr.IsScatterGather() && (addr.GetRegCount() == 1));
+  VIXL_ASSERT(LaneCountFromFormat(vform) <= kMaxGatherScatterLanes);
+  int count = 0;
+  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
+    if (!pg.IsActive(vform, i)) continue;
+    lanes[count] = i;
+    addresses[count] = addr.GetElementAddress(i, 0);
+    count++;
+  }
+
+  // Look for a constant stride, measured per lane so that inactive lanes
+  // between active ones don't hide the pattern.
+  *stride = 0;
+  if (count >= 2) {
+    int64_t delta = static_cast<int64_t>(addresses[1] - addresses[0]);
+    int lane_delta = lanes[1] - lanes[0];
+    if ((delta != 0) && ((delta % lane_delta) == 0)) {
+      uint64_t candidate = static_cast<uint64_t>(delta / lane_delta);
+      bool is_constant = true;
+      for (int k = 2; is_constant && (k < count); k++) {
+        uint64_t expected = addresses[0] + (candidate * (lanes[k] - lanes[0]));
+        is_constant = (addresses[k] == expected);
+      }
+      if (is_constant) *stride = delta / lane_delta;
+    }
+  }
+
+  // Count the distinct lines touched. An element that crosses a line
+  // boundary touches two lines.
+  int msize = addr.GetMsizeInBytes();
+  uint64_t lines[2 * kMaxGatherScatterLanes];
+  int line_count = 0;
+  for (int k = 0; k < count; k++) {
+    uint64_t first = addresses[k] >> SimGatherScatterStats::kLineSizeLog2;
+    uint64_t last =
+        (addresses[k] + msize - 1) >> SimGatherScatterStats::kLineSizeLog2;
+    lines[line_count++] = first;
+    if (last != first) lines[line_count++] = last;
+  }
+  std::sort(lines, lines + line_count);
+
+  gather_scatter_stats_.elements += count;
+  gather_scatter_stats_.unique_lines +=
+      std::unique(lines, lines + line_count) - lines;
+  if (*stride == msize) {
+    gather_scatter_stats_.contiguous++;
+  } else if (*stride != 0) {
+    gather_scatter_stats_.strided++;
+  }
+  return count;
+}
+
+bool Simulator::SVEGatherLoadHelper(VectorFormat vform,
+                                    const LogicPRegister& pg,
+                                    LogicVRegister zt,
+                                    const LogicSVEAddressVector& addr,
+                                    bool is_signed) {
+  uint64_t addresses[kMaxGatherScatterLanes];
+  int lanes[kMaxGatherScatterLanes];
+  int64_t stride;
+  int count =
+      GetGatherScatterAddresses(vform, pg, addr, addresses, lanes, &stride);
+  gather_scatter_stats_.gathers++;
+  const int kFlags = MemoryTraceRecord::kVector | MemoryTraceRecord::kGather;
+
+  int msize = addr.GetMsizeInBytes();
+  if (stride == msize) {
+    // The active elements are adjacent in memory, so this is equivalent to a
+    // contiguous load based at the address that lane 0 would have used.
+    LogicSVEAddressVector block(addresses[0] - (lanes[0] * msize));
+    block.SetMsizeInBytesLog2(addr.GetMsizeInBytesLog2());
+    return SVEContiguousLoadHelper(vform, pg, &zt, block, is_signed, kFlags);
+  }
+
+  uint64_t values[kMaxGatherScatterLanes];
+  if (stride != 0) {
+    for (int k = 0; k < count; k++) {
+      values[k] = 0;
+      MemReadBlock(addresses[k], &values[k], msize, kFlags);
+    }
+  } else {
+    // Visit the elements in address order, so that elements sharing an
+    // address are adjacent and only the first of them needs to be read.
+    std::pair<uint64_t, int> order[kMaxGatherScatterLanes];
+    for (int k = 0; k < count; k++) order[k] = std::make_pair(addresses[k], k);
+    std::sort(order, order + count);
+    for (int k = 0; k < count; k++) {
+      int element = order[k].second;
+      if ((k > 0) && (order[k].first == order[k - 1].first)) {
+        values[element] = values[order[k - 1].second];
+        gather_scatter_stats_.coalesced_elements++;
+      } else {
+        values[element] = 0;
+        MemReadBlock(order[k].first, &values[element], msize, kFlags);
+      }
+    }
+  }
+
+  int esize = LaneSizeInBytesFromFormat(vform);
+  int msb = (msize * kBitsPerByte) - 1;
+  uint8_t data[kZRegMaxSizeInBytes];
+  memset(data, 0, sizeof(data));
+  for (int k = 0; k < count; k++) {
+    uint64_t value = values[k];
+    if (is_signed) value = ExtractSignedBitfield64(msb, 0, value);
+    memcpy(&data[lanes[k] * esize], &value, esize);
+  }
+  zt.WriteLanes(data, LaneCountFromFormat(vform) * esize);
+  return true;
+}
+
+bool Simulator::SVEScatterStoreHelper(VectorFormat vform,
+                                      const LogicPRegister& pg,
+                                      const LogicVRegister& zt,
+                                      const LogicSVEAddressVector& addr) {
+  uint64_t addresses[kMaxGatherScatterLanes];
+  int lanes[kMaxGatherScatterLanes];
+  int64_t stride;
+  int count =
+      GetGatherScatterAddresses(vform, pg, addr, addresses, lanes, &stride);
+  gather_scatter_stats_.scatters++;
+  const int kFlags = MemoryTraceRecord::kVector | MemoryTraceRecord::kGather;
+
+  int msize = addr.GetMsizeInBytes();
+  if (stride == msize) {
+    LogicSVEAddressVector block(addresses[0] - (lanes[0] * msize));
+    block.SetMsizeInBytesLog2(addr.GetMsizeInBytesLog2());
+    return SVEContiguousStoreHelper(vform, pg, &zt, block, kFlags);
+  }
+
+  bool skip[kMaxGatherScatterLanes] = {};
+  if ((stride == 0) && (count > 1)) {
+    // Where several elements share an address, only the highest-numbered one
+    // is visible after the store, so the others need not be written. Partially
+    // overlapping elements are still written in lane order.
+    std::pair<uint64_t, int> order[kMaxGatherScatterLanes];
+    for (int k = 0; k < count; k++) order[k] = std::make_pair(addresses[k], k);
+    std::sort(order, order + count);
+    for (int k = 0; k < (count - 1); k++) {
+      if (order[k].first == order[k + 1].first) {
+        skip[order[k].second] = true;
+        gather_scatter_stats_.coalesced_elements++;
+      }
+    }
+  }
+
+  int esize = LaneSizeInBytesFromFormat(vform);
+  uint8_t data[kZRegMaxSizeInBytes];
+  zt.ReadLanes(data, LaneCountFromFormat(vform) * esize);
+  for (int k = 0; k < count; k++) {
+    if (skip[k]) continue;
+    MemWriteBlock(addresses[k], &data[lanes[k] * esize], msize, kFlags);
+  }
+  return true;
+}
+
 void Simulator::SVEStructuredLoadHelper(VectorFormat vform,
                                         const LogicPRegister& pg,
                                         unsigned zt_code,
@@ -7068,19 +7475,38 @@ void Simulator::SVEStructuredLoadHelper(VectorFormat vform,
       ReadVRegister(zt_codes[3]),
   };
 
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    for (int r = 0; r < reg_count; r++) {
-      uint64_t element_address = addr.GetElementAddress(i, r);
+  int flags = MemoryTraceRecord::kVector;
+  if (addr.IsScatterGather()) flags |= MemoryTraceRecord::kGather;
 
-      if (!pg.IsActive(vform, i)) {
-        zt[r].SetUint(vform, i, 0);
-        continue;
-      }
+  bool done =
+      addr.IsContiguous()
+          ? SVEContiguousLoadHelper(vform, pg, zt, addr, is_signed, flags)
+          : SVEGatherLoadHelper(vform, pg, zt[0], addr, is_signed);
+  if (!done) {
+    for (int i = 0; i < LaneCountFromFormat(vform); i++) {
+      for (int r = 0; r < reg_count; r++) {
+        uint64_t element_address = addr.GetElementAddress(i, r);
 
-      if (is_signed) {
-        LoadIntToLane(zt[r], vform, msize_in_bytes, i, element_address);
-      } else {
-        LoadUintToLane(zt[r], vform, msize_in_bytes, i, element_address);
+        if (!pg.IsActive(vform, i)) {
+          zt[r].SetUint(vform, i, 0);
+          continue;
+        }
+
+        if (is_signed) {
+          LoadIntToLane(zt[r],
+                        vform,
+                        msize_in_bytes,
+                        i,
+                        element_address,
+                        flags);
+        } else {
+          LoadUintToLane(zt[r],
+                         vform,
+                         msize_in_bytes,
+                         i,
+                         element_address,
+                         flags);
+        }
       }
     }
   }
@@ -7101,31 +7527,47 @@ void Simulator::SVEStructuredLoadHelper(VectorFormat vform,
   }
 }
 
+// Return a mask of the predicate bits in word `index` that precede the first
+// active bit in `pg & pn`. If `inclusive` is true, that first active bit is
+// included too. The mask is all-true if there are no active bits.
+static uint64_t GetBreakMask(int index,
+                             const LogicPRegister& pg,
+                             const LogicPRegister& pn,
+                             bool inclusive) {
+  for (int i = 0; i < index; i++) {
+    // The break happened in an earlier word.
+    if ((pg.GetWord(i) & pn.GetWord(i)) != 0) return 0;
+  }
+  uint64_t active = pg.GetWord(index) & pn.GetWord(index);
+  if (active == 0) return ~UINT64_C(0);
+  uint64_t lowest = active & ~(active - 1);
+  return inclusive ? (lowest | (lowest - 1)) : (lowest - 1);
+}
+
 LogicPRegister Simulator::brka(LogicPRegister pd,
                                const LogicPRegister& pg,
                                const LogicPRegister& pn) {
-  bool break_ = false;
-  for (int i = 0; i < LaneCountFromFormat(kFormatVnB); i++) {
-    if (pg.IsActive(kFormatVnB, i)) {
-      pd.SetActive(kFormatVnB, i, !break_);
-      break_ |= pn.IsActive(kFormatVnB, i);
-    }
-  }
-
+  // Compute the masks before writing to `pd`, which may alias `pn`.
+  uint64_t result[kPRegMaxSize / kXRegSize];
+  for (int i = 0; i < GetPredicateWordCount(); i++) {
+    uint64_t mask = pg.GetWord(i);
+    uint64_t active = GetBreakMask(i, pg, pn, true);
+    result[i] = (mask & active) | (~mask & pd.GetWord(i));
+  }
+  for (int i = 0; i < GetPredicateWordCount(); i++) pd.SetWord(i, result[i]);
   return pd;
 }
 
 LogicPRegister Simulator::brkb(LogicPRegister pd,
                                const LogicPRegister& pg,
                                const LogicPRegister& pn) {
-  bool break_ = false;
-  for (int i = 0; i < LaneCountFromFormat(kFormatVnB); i++) {
-    if (pg.IsActive(kFormatVnB, i)) {
-      break_ |= pn.IsActive(kFormatVnB, i);
-      pd.SetActive(kFormatVnB, i, !break_);
-    }
+  uint64_t result[kPRegMaxSize / kXRegSize];
+  for (int i = 0; i < GetPredicateWordCount(); i++) {
+    uint64_t mask = pg.GetWord(i);
+    uint64_t active = GetBreakMask(i, pg, pn, false);
+    result[i] = (mask & active) | (~mask & pd.GetWord(i));
   }
-
+  for (int i = 0; i < GetPredicateWordCount(); i++) pd.SetWord(i, result[i]);
   return pd;
 }
 
@@ -7142,17 +7584,13 @@ LogicPRegister Simulator::brkpa(LogicPRegister pd,
                                 const LogicPRegister& pg,
                                 const LogicPRegister& pn,
                                 const LogicPRegister& pm) {
-  bool last_active = IsLastActive(kFormatVnB, pg, pn);
+  if (!IsLastActive(kFormatVnB, pg, pn)) return pfalse(pd);
 
-  for (int i = 0; i < LaneCountFromFormat(kFormatVnB); i++) {
-    bool active = false;
-    if (pg.IsActive(kFormatVnB, i)) {
-      active = last_active;
-      last_active = last_active && !pm.IsActive(kFormatVnB, i);
-    }
-    pd.SetActive(kFormatVnB, i, active);
+  uint64_t result[kPRegMaxSize / kXRegSize];
+  for (int i = 0; i < GetPredicateWordCount(); i++) {
+    result[i] = pg.GetWord(i) & GetBreakMask(i, pg, pm, true);
   }
-
+  for (int i = 0; i < GetPredicateWordCount(); i++) pd.SetWord(i, result[i]);
   return pd;
 }
 
@@ -7160,17 +7598,13 @@ LogicPRegister Simulator::brkpb(LogicPRegister pd,
                                 const LogicPRegister& pg,
                                 const LogicPRegister& pn,
                                 const LogicPRegister& pm) {
-  bool last_active = IsLastActive(kFormatVnB, pg, pn);
+  if (!IsLastActive(kFormatVnB, pg, pn)) return pfalse(pd);
 
-  for (int i = 0; i < LaneCountFromFormat(kFormatVnB); i++) {
-    bool active = false;
-    if (pg.IsActive(kFormatVnB, i)) {
-      last_active = last_active && !pm.IsActive(kFormatVnB, i);
-      active = last_active;
-    }
-    pd.SetActive(kFormatVnB, i, active);
+  uint64_t result[kPRegMaxSize / kXRegSize];
+  for (int i = 0; i < GetPredicateWordCount(); i++) {
+    result[i] = pg.GetWord(i) & GetBreakMask(i, pg, pm, false);
   }
-
+  for (int i = 0; i < GetPredicateWordCount(); i++) pd.SetWord(i, result[i]);
   return pd;
 }
 
@@ -7190,6 +7624,8 @@ void Simulator::SVEFaultTolerantLoadHelper(VectorFormat vform,
 
   LogicVRegister zt = ReadVRegister(zt_code);
   LogicPRegister ffr = ReadFFR();
+  int flags = MemoryTraceRecord::kVector;
+  if (addr.IsScatterGather()) flags |= MemoryTraceRecord::kGather;
 
   // Non-faulting loads are allowed to fail arbitrarily. To stress user
   // code, fail a random element in roughly one in eight full-vector loads.
@@ -7206,7 +7642,7 @@ void Simulator::SVEFaultTolerantLoadHelper(VectorFormat vform,
         // First-faulting loads always load the first active element, regardless
         // of FFR. The result will be discarded if its FFR lane is inactive, but
         // it could still generate a fault.
-        value = MemReadUint(msize_in_bytes, element_address);
+        value = MemReadUint(msize_in_bytes, element_address, flags);
         // All subsequent elements have non-fault semantics.
         type = kSVENonFaultLoad;
 
@@ -7218,7 +7654,7 @@ void Simulator::SVEFaultTolerantLoadHelper(VectorFormat vform,
         bool can_read = (i < fake_fault_at_lane) &&
                         CanReadMemory(element_address, msize_in_bytes);
         if (can_read) {
-          value = MemReadUint(msize_in_bytes, element_address);
+          value = MemReadUint(msize_in_bytes, element_address, flags);
         } else {
           // Propagate the fault to the end of FFR.
           for (int j = i; j < LaneCountFromFormat(vform); j++) {
@@ -7292,16 +7728,24 @@ void Simulator::SVEGatherLoadScalarPlusVectorHelper(const Instruction* instr,
 
 int Simulator::GetFirstActive(VectorFormat vform,
                               const LogicPRegister& pg) const {
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    if (pg.IsActive(vform, i)) return i;
+  for (int i = 0; i < GetPredicateWordCount(); i++) {
+    uint64_t active = pg.GetWord(i) & GetPredicateLaneMask(vform, i);
+    if (active != 0) {
+      int bit = (i * kXRegSize) + CountTrailingZeros(active);
+      return bit / LaneSizeInBytesFromFormat(vform);
+    }
   }
   return -1;
 }
 
 int Simulator::GetLastActive(VectorFormat vform,
                              const LogicPRegister& pg) const {
-  for (int i = LaneCountFromFormat(vform) - 1; i >= 0; i--) {
-    if (pg.IsActive(vform, i)) return i;
+  for (int i = GetPredicateWordCount() - 1; i >= 0; i--) {
+    uint64_t active = pg.GetWord(i) & GetPredicateLaneMask(vform, i);
+    if (active != 0) {
+      int bit = (i * kXRegSize) + (kXRegSize - 1) - CountLeadingZeros(active);
+      return bit / LaneSizeInBytesFromFormat(vform);
+    }
   }
   return -1;
 }
@@ -7309,8 +7753,8 @@ int Simulator::GetLastActive(VectorFormat vform,
 int Simulator::CountActiveLanes(VectorFormat vform,
                                 const LogicPRegister& pg) const {
   int count = 0;
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    count += pg.IsActive(vform, i) ? 1 : 0;
+  for (int i = 0; i < GetPredicateWordCount(); i++) {
+    count += CountSetBits(pg.GetWord(i) & GetPredicateLaneMask(vform, i));
   }
   return count;
 }
@@ -7319,12 +7763,33 @@ int Simulator::CountActiveAndTrueLanes(VectorFormat vform,
                                        const LogicPRegister& pg,
                                        const LogicPRegister& pn) const {
   int count = 0;
-  for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-    count += (pg.IsActive(vform, i) && pn.IsActive(vform, i)) ? 1 : 0;
+  for (int i = 0; i < GetPredicateWordCount(); i++) {
+    uint64_t lane_mask = GetPredicateLaneMask(vform, i);
+    count += CountSetBits(pg.GetWord(i) & pn.GetWord(i) & lane_mask);
   }
   return count;
 }
 
+LogicPRegister Simulator::SetLeadingActiveLanes(VectorFormat vform,
+                                                LogicPRegister dst,
+                                                int count) {
+  VIXL_ASSERT((count >= 0) && (count <= LaneCountFromFormat(vform)));
+  uint64_t lane_mask = LogicPRegister::GetLaneMask(vform);
+  int active_bits = count * LaneSizeInBytesFromFormat(vform);
+  const int word_size = kXRegSize;
+  for (int i = 0; i < dst.GetWordCount(); i++) {
+    int bits = active_bits - (i * word_size);
+    uint64_t word = 0;
+    if (bits >= word_size) {
+      word = lane_mask;
+    } else if (bits > 0) {
+      word = lane_mask & GetUintMask(bits);
+    }
+    dst.SetWord(i, word);
+  }
+  return dst;
+}
+
 int Simulator::GetPredicateConstraintLaneCount(VectorFormat vform,
                                                int pattern) const {
   VIXL_ASSERT(IsSVEFormat(vform));
@@ -61,10 +61,26 @@ LiteralPool::~LiteralPool() VIXL_NEGATIVE_TESTING_ALLOW_EXCEPTION {
        it++) {
     delete *it;
   }
+  for (SharedLiteralMap::iterator it = placed_shared_.begin();
+       it != placed_shared_.end();
+       it++) {
+    delete it->second;
+  }
 }
 
 
 void LiteralPool::Reset() {
+  ResetPendingEntries();
+  for (SharedLiteralMap::iterator it = placed_shared_.begin();
+       it != placed_shared_.end();
+       it++) {
+    delete it->second;
+  }
+  placed_shared_.clear();
+}
+
+
+void LiteralPool::ResetPendingEntries() {
   std::vector<RawLiteral*>::iterator it, end;
   for (it = entries_.begin(), end = entries_.end(); it != end; ++it) {
     RawLiteral* literal = *it;
@@ -73,6 +89,7 @@ void LiteralPool::Reset() {
     }
   }
   entries_.clear();
+  pending_shared_.clear();
   size_ = 0;
   first_use_ = -1;
   Pool::Reset();
@@ -80,11 +97,59 @@ void LiteralPool::Reset() {
 }
 
 
-void LiteralPool::CheckEmitFor(size_t amount, EmitOption option) {
-  if (IsEmpty() || IsBlocked()) return;
+RawLiteral* LiteralPool::FindSharedLiteral(const LiteralKey& key) {
+  SharedLiteralMap::iterator it = pending_shared_.find(key);
+  if (it != pending_shared_.end()) return it->second;
+
+  it = placed_shared_.find(key);
+  if (it != placed_shared_.end()) {
+    ptrdiff_t distance = masm_->GetCursorOffset() - it->second->GetOffset();
+    if ((distance > 0) && (distance < kRecommendedLiteralPoolRange)) {
+      return it->second;
+    }
+    delete it->second;
+    placed_shared_.erase(it);
+  }
+  return NULL;
+}
+
+
+void LiteralPool::RetainPlacedSharedLiterals() {
+  ptrdiff_t cursor = masm_->GetCursorOffset();
+  SharedLiteralMap::iterator it = placed_shared_.begin();
+  while (it != placed_shared_.end()) {
+    if ((cursor - it->second->GetOffset()) >= kRecommendedLiteralPoolRange) {
+      delete it->second;
+      it = placed_shared_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (it = pending_shared_.begin(); it != pending_shared_.end(); ++it) {
+    RawLiteral* literal = it->second;
+    VIXL_ASSERT(literal->IsPlaced());
+    // From now on the literal is owned by `placed_shared_`, not by its
+    // deletion policy.
+    literal->deletion_policy_ = RawLiteral::kManuallyDeleted;
+    RawLiteral*& placed = placed_shared_[it->first];
+    delete placed;
+    placed = literal;
+  }
+  pending_shared_.clear();
+}
+
+
+bool LiteralPool::ShouldEmitFor(size_t amount) const {
+  if (IsEmpty() || IsBlocked()) return false;
 
   ptrdiff_t distance = masm_->GetCursorOffset() + amount - first_use_;
-  if (distance >= kRecommendedLiteralPoolRange) {
+  return distance >= kRecommendedLiteralPoolRange;
+}
+
+
+void LiteralPool::CheckEmitFor(size_t amount, EmitOption option) {
+  if (ShouldEmitFor(amount)) {
     Emit(option);
   }
 }
@@ -109,6 +174,7 @@ class ExactAssemblyScopeWithoutPoolsCheck : public ExactAssemblyScope {
 
   friend void LiteralPool::Emit(LiteralPool::EmitOption);
   friend void VeneerPool::Emit(VeneerPool::EmitOption, size_t);
+  friend class MacroAssembler;
 };
 
 
@@ -157,7 +223,8 @@ void LiteralPool::Emit(EmitOption option) {
 #endif
   }
 
-  Reset();
+  RetainPlacedSharedLiterals();
+  ResetPendingEntries();
 }
 
 
@@ -319,6 +386,7 @@ MacroAssembler::MacroAssembler(PositionIndependentCodeOption pic)
       allow_macro_instructions_(true),
 #endif
       generate_simulator_code_(VIXL_AARCH64_GENERATE_SIMULATOR_CODE),
+      in_bulk_emission_(false),
       sp_(sp),
       tmp_list_(ip0, ip1),
       v_tmp_list_(d31),
@@ -342,6 +410,7 @@ MacroAssembler::MacroAssembler(size_t capacity,
       allow_macro_instructions_(true),
 #endif
       generate_simulator_code_(VIXL_AARCH64_GENERATE_SIMULATOR_CODE),
+      in_bulk_emission_(false),
       sp_(sp),
       tmp_list_(ip0, ip1),
       v_tmp_list_(d31),
@@ -363,6 +432,7 @@ MacroAssembler::MacroAssembler(byte* buffer,
       allow_macro_instructions_(true),
 #endif
       generate_simulator_code_(VIXL_AARCH64_GENERATE_SIMULATOR_CODE),
+      in_bulk_emission_(false),
       sp_(sp),
       tmp_list_(ip0, ip1),
       v_tmp_list_(d31),
@@ -410,12 +480,44 @@ void MacroAssembler::CheckEmitFor(size_t amount) {
 
 
 void MacroAssembler::CheckEmitPoolsFor(size_t amount) {
-  literal_pool_.CheckEmitFor(amount);
-  veneer_pool_.CheckEmitFor(amount);
+  // When either pool has to be emitted, the other one is emitted with it, so
+  // that both share the branch over the pool.
+  bool emit_veneers = !veneer_pool_.IsEmpty() && !veneer_pool_.IsBlocked() &&
+                      veneer_pool_.ShouldEmitVeneers(amount);
+  if (emit_veneers || literal_pool_.ShouldEmitFor(amount)) {
+    EmitPools(amount, Pool::kBranchRequired);
+  } else if (!veneer_pool_.IsEmpty()) {
+    VIXL_ASSERT(GetCursorOffset() + VeneerPool::kPoolNonVeneerCodeSize <
+                veneer_pool_.GetCheckpoint());
+    veneer_pool_.UpdateNextCheckPoint();
+  }
   checkpoint_ = GetNextCheckPoint();
 }
 
 
+void MacroAssembler::EmitPools(size_t amount, Pool::EmitOption option) {
+  bool emit_literals = !literal_pool_.IsEmpty() && !literal_pool_.IsBlocked();
+  bool emit_veneers = !veneer_pool_.IsEmpty() && !veneer_pool_.IsBlocked();
+  VIXL_ASSERT(emit_literals || emit_veneers);
+
+  Label end_of_pools;
+  if (option == Pool::kBranchRequired) {
+    ExactAssemblyScopeWithoutPoolsCheck guard(this, kInstructionSize);
+    b(&end_of_pools);
+  }
+
+  // The literal pool goes first. Veneer emission already accounts for the
+  // size of the literal pool, so the branches are still in range afterwards.
+  if (emit_literals) {
+    literal_pool_.Emit(Pool::kNoBranchRequired);
+    recommended_checkpoint_ = Pool::kNoCheckpointRequired;
+  }
+  if (emit_veneers) veneer_pool_.Emit(Pool::kNoBranchRequired, amount);
+
+  bind(&end_of_pools);
+}
+
+
 int MacroAssembler::MoveImmediateHelper(MacroAssembler* masm,
                                         const Register& rd,
                                         uint64_t imm) {
@@ -29,6 +29,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <unordered_map>
 
 #include "../code-generation-scopes-vixl.h"
 #include "../globals-vixl.h"
@@ -124,6 +125,7 @@ class LiteralPool : public Pool {
     return GetOtherPoolsMaxSize();
   }
 
+  bool ShouldEmitFor(size_t amount) const;
   void CheckEmitFor(size_t amount, EmitOption option = kBranchRequired);
   // Check whether we need to emit the literal pool in order to be able to
   // safely emit a branch with a given range.
@@ -143,10 +145,49 @@ class LiteralPool : public Pool {
     deleted_on_destruction_.push_back(literal);
   }
 
+  // Return a literal holding `value`, owned by the pool and deleted by it.
+  // Literals are shared between loads of the same value: a pending literal
+  // is reused, and so is a placed one within kRecommendedLiteralPoolRange of
+  // the cursor. The literal returned must be used immediately.
+  template <typename T>
+  RawLiteral* GetSharedLiteral(T value);
+  template <typename T>
+  RawLiteral* GetSharedLiteral(T high64, T low64);
+
+  size_t GetNumberOfSharedLiterals() const {
+    return pending_shared_.size() + placed_shared_.size();
+  }
+
   // Recommended not exact since the pool can be blocked for short periods.
   static const ptrdiff_t kRecommendedLiteralPoolRange = 128 * KBytes;
 
  private:
+  struct LiteralKey {
+    LiteralKey(size_t size, uint64_t low64, uint64_t high64)
+        : size(size), low64(low64), high64(high64) {}
+    bool operator==(const LiteralKey& other) const {
+      return (size == other.size) && (low64 == other.low64) &&
+             (high64 == other.high64);
+    }
+    size_t size;
+    uint64_t low64;
+    uint64_t high64;
+  };
+
+  struct LiteralKeyHash {
+    size_t operator()(const LiteralKey& key) const {
+      uint64_t hash = key.low64 ^ (key.high64 * 0x9e3779b97f4a7c15) ^ key.size;
+      return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+  };
+
+  typedef std::unordered_map<LiteralKey, RawLiteral*, LiteralKeyHash>
+      SharedLiteralMap;
+
+  RawLiteral* FindSharedLiteral(const LiteralKey& key);
+  void RetainPlacedSharedLiterals();
+  void ResetPendingEntries();
+
   std::vector<RawLiteral*> entries_;
   size_t size_;
   ptrdiff_t first_use_;
@@ -158,6 +199,11 @@ class LiteralPool : public Pool {
   ptrdiff_t recommended_checkpoint_;
 
   std::vector<RawLiteral*> deleted_on_destruction_;
+
+  // Shared literals, see `GetSharedLiteral()`. The pending ones are also in
+  // `entries_`. The placed ones are owned by these maps.
+  SharedLiteralMap pending_shared_;
+  SharedLiteralMap placed_shared_;
 };
 
 
@@ -178,6 +224,38 @@ inline ptrdiff_t LiteralPool::GetNextRecommendedCheckpoint() {
 }
 
 
+template <typename T>
+RawLiteral* LiteralPool::GetSharedLiteral(T value) {
+  VIXL_STATIC_ASSERT(sizeof(value) <= kXRegSizeInBytes);
+  uint64_t raw = 0;
+  memcpy(&raw, &value, sizeof(value));
+  LiteralKey key(sizeof(value), raw, 0);
+  RawLiteral* literal = FindSharedLiteral(key);
+  if (literal == NULL) {
+    literal =
+        new Literal<T>(value, this, RawLiteral::kDeletedOnPlacementByPool);
+    pending_shared_[key] = literal;
+  }
+  return literal;
+}
+
+
+template <typename T>
+RawLiteral* LiteralPool::GetSharedLiteral(T high64, T low64) {
+  VIXL_STATIC_ASSERT(sizeof(low64) == kXRegSizeInBytes);
+  LiteralKey key(2 * sizeof(low64), low64, high64);
+  RawLiteral* literal = FindSharedLiteral(key);
+  if (literal == NULL) {
+    literal = new Literal<T>(high64,
+                             low64,
+                             this,
+                             RawLiteral::kDeletedOnPlacementByPool);
+    pending_shared_[key] = literal;
+  }
+  return literal;
+}
+
+
 class VeneerPool : public Pool {
  public:
   explicit VeneerPool(MacroAssembler* masm) : Pool(masm) {}
@@ -508,21 +586,24 @@ class VeneerPool : public Pool {
 
 // Helper for common Emission checks.
 // The macro-instruction maps to a single instruction.
+// Inside a BulkEmissionScope, this does nothing.
 class SingleEmissionCheckScope : public EmissionCheckScope {
  public:
   explicit SingleEmissionCheckScope(MacroAssemblerInterface* masm)
       : EmissionCheckScope(masm, kInstructionSize) {}
+  explicit inline SingleEmissionCheckScope(MacroAssembler* masm);
 };
 
 
 // The macro instruction is a "typical" macro-instruction. Typical macro-
 // instruction only emit a few instructions, a few being defined as 8 here.
+// Inside a BulkEmissionScope, this does nothing.
 class MacroEmissionCheckScope : public EmissionCheckScope {
  public:
   explicit MacroEmissionCheckScope(MacroAssemblerInterface* masm)
       : EmissionCheckScope(masm, kTypicalMacroInstructionMaxSize) {}
+  explicit inline MacroEmissionCheckScope(MacroAssembler* masm);
 
- private:
   static const size_t kTypicalMacroInstructionMaxSize = 8 * kInstructionSize;
 };
 
@@ -1921,13 +2002,9 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
     SingleEmissionCheckScope guard(this);
     RawLiteral* literal;
     if (vt.IsD()) {
-      literal = new Literal<double>(imm,
-                                    &literal_pool_,
-                                    RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetSharedLiteral(imm);
     } else {
-      literal = new Literal<float>(static_cast<float>(imm),
-                                   &literal_pool_,
-                                   RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetSharedLiteral(static_cast<float>(imm));
     }
     ldr(vt, literal);
   }
@@ -1936,13 +2013,9 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
     SingleEmissionCheckScope guard(this);
     RawLiteral* literal;
     if (vt.IsS()) {
-      literal = new Literal<float>(imm,
-                                   &literal_pool_,
-                                   RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetSharedLiteral(imm);
     } else {
-      literal = new Literal<double>(static_cast<double>(imm),
-                                    &literal_pool_,
-                                    RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetSharedLiteral(static_cast<double>(imm));
     }
     ldr(vt, literal);
   }
@@ -1950,11 +2023,7 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
     VIXL_ASSERT(allow_macro_instructions_);
     VIXL_ASSERT(vt.IsQ());
     SingleEmissionCheckScope guard(this);
-    ldr(vt,
-        new Literal<uint64_t>(high64,
-                              low64,
-                              &literal_pool_,
-                              RawLiteral::kDeletedOnPlacementByPool));
+    ldr(vt, literal_pool_.GetSharedLiteral(high64, low64));
   }
   void Ldr(const Register& rt, uint64_t imm) {
     VIXL_ASSERT(allow_macro_instructions_);
@@ -1962,15 +2031,11 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
     SingleEmissionCheckScope guard(this);
     RawLiteral* literal;
     if (rt.Is64Bits()) {
-      literal = new Literal<uint64_t>(imm,
-                                      &literal_pool_,
-                                      RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetSharedLiteral(imm);
     } else {
       VIXL_ASSERT(rt.Is32Bits());
       VIXL_ASSERT(IsUint32(imm) || IsInt32(imm));
-      literal = new Literal<uint32_t>(static_cast<uint32_t>(imm),
-                                      &literal_pool_,
-                                      RawLiteral::kDeletedOnPlacementByPool);
+      literal = literal_pool_.GetSharedLiteral(static_cast<uint32_t>(imm));
     }
     ldr(rt, literal);
   }
@@ -1978,10 +2043,7 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
     VIXL_ASSERT(allow_macro_instructions_);
     VIXL_ASSERT(!rt.IsZero());
     SingleEmissionCheckScope guard(this);
-    ldrsw(rt,
-          new Literal<uint32_t>(imm,
-                                &literal_pool_,
-                                RawLiteral::kDeletedOnPlacementByPool));
+    ldrsw(rt, literal_pool_.GetSharedLiteral(imm));
   }
   void Ldr(const CPURegister& rt, RawLiteral* literal) {
     VIXL_ASSERT(allow_macro_instructions_);
@@ -6407,6 +6469,11 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
 
   bool GenerateSimulatorCode() const { return generate_simulator_code_; }
 
+  // Inside a BulkEmissionScope, buffer space has been reserved and pools have
+  // been checked for the whole sequence, so most macro instructions skip their
+  // own emission checks.
+  bool IsInBulkEmission() const { return in_bulk_emission_; }
+
   size_t GetLiteralPoolSize() const { return literal_pool_.GetSize(); }
   VIXL_DEPRECATED("GetLiteralPoolSize", size_t LiteralPoolSize() const) {
     return GetLiteralPoolSize();
@@ -6445,7 +6512,9 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
     if (!literal_pool_.IsEmpty()) literal_pool_.Emit(option);
 
     checkpoint_ = GetNextCheckPoint();
-    recommended_checkpoint_ = literal_pool_.GetNextRecommendedCheckpoint();
+    // The pool is now empty, so nothing is recommended until the next literal
+    // is added.
+    recommended_checkpoint_ = Pool::kNoCheckpointRequired;
   }
 
   void CheckEmitFor(size_t amount);
@@ -6607,12 +6676,17 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
     ReleaseVeneerPool();
   }
 
+  // Emit the literal pool and the veneers that will soon be needed together,
+  // behind a single branch. Blocked pools are left untouched.
+  void EmitPools(size_t amount, Pool::EmitOption option);
+
   // The scopes below need to able to block and release a particular pool.
   // TODO: Consider removing those scopes or move them to
   // code-generation-scopes-vixl.h.
   friend class BlockPoolsScope;
   friend class BlockLiteralPoolScope;
   friend class BlockVeneerPoolScope;
+  friend class BulkEmissionScope;
 
   virtual void SetAllowMacroInstructions(bool value) VIXL_OVERRIDE {
     allow_macro_instructions_ = value;
@@ -6927,6 +7001,9 @@ class MacroAssembler : public Assembler, public MacroAssemblerInterface {
   // Indicates whether we should generate simulator or native code.
   bool generate_simulator_code_;
 
+  // True inside a BulkEmissionScope.
+  bool in_bulk_emission_;
+
   // The register to use as a stack pointer for stack operations.
   Register sp_;
 
@@ -7013,6 +7090,85 @@ class BlockPoolsScope {
   MacroAssembler* masm_;
 };
 
+
+// Reserve space for a long, straight-line sequence of macro instructions (such
+// as an unrolled loop or a large prologue), and check the pools once for the
+// whole sequence, rather than once per macro instruction.
+//
+// Pools are blocked for the duration of the scope, and the
+// SingleEmissionCheckScope and MacroEmissionCheckScope used by most macro
+// instructions do nothing. Macro instructions that can emit longer sequences
+// still make their own checks.
+//
+// The code emitted must fit in `size` bytes. This is checked when the scope is
+// closed, in all build modes. Literals and branches created in the scope can
+// only be placed after it, so `size` is limited to kMaxSize, which keeps them
+// in range.
+//
+// Like EmissionCheckScope, the scope can be constructed without a
+// MacroAssembler, and opened later, so that it can be used conditionally.
+class BulkEmissionScope : public EmissionCheckScope {
+ public:
+  static const size_t kMaxSize = 16 * KBytes;
+
+  BulkEmissionScope(MacroAssembler* masm, size_t size)
+      : macro_assembler_(NULL),
+        max_cursor_offset_(0),
+        previous_in_bulk_emission_(false) {
+    Open(masm, size);
+  }
+
+  BulkEmissionScope()
+      : macro_assembler_(NULL),
+        max_cursor_offset_(0),
+        previous_in_bulk_emission_(false) {}
+
+  virtual ~BulkEmissionScope() { Close(); }
+
+  void Open(MacroAssembler* masm, size_t size) {
+    VIXL_ASSERT(macro_assembler_ == NULL);
+    VIXL_ASSERT(size <= kMaxSize);
+    EmissionCheckScope::Open(masm, size);
+    macro_assembler_ = masm;
+    max_cursor_offset_ = masm->GetCursorOffset() + size;
+    previous_in_bulk_emission_ = masm->IsInBulkEmission();
+    masm->in_bulk_emission_ = true;
+  }
+
+  void Close() {
+    if (macro_assembler_ != NULL) {
+      macro_assembler_->in_bulk_emission_ = previous_in_bulk_emission_;
+      VIXL_CHECK(macro_assembler_->GetCursorOffset() <= max_cursor_offset_);
+      macro_assembler_ = NULL;
+    }
+    EmissionCheckScope::Close();
+  }
+
+  // An upper bound on the size of `count` typical macro instructions.
+  static size_t GetSizeForMacroInstructions(size_t count) {
+    return count * MacroEmissionCheckScope::kTypicalMacroInstructionMaxSize;
+  }
+
+ private:
+  MacroAssembler* macro_assembler_;
+  ptrdiff_t max_cursor_offset_;
+  bool previous_in_bulk_emission_;
+};
+
+
+SingleEmissionCheckScope::SingleEmissionCheckScope(MacroAssembler* masm) {
+  if ((masm != NULL) && !masm->IsInBulkEmission()) {
+    Open(masm, kInstructionSize);
+  }
+}
+
+
+MacroEmissionCheckScope::MacroEmissionCheckScope(MacroAssembler* masm) {
+  if ((masm != NULL) && !masm->IsInBulkEmission()) {
+    Open(masm, kTypicalMacroInstructionMaxSize);
+  }
+}
+
 MovprfxHelperScope::MovprfxHelperScope(MacroAssembler* masm,
                                        const ZRegister& dst,
                                        const ZRegister& src)
@@ -7290,9 +7446,15 @@ void MacroAssembler::CallRuntimeHelper(R (*function)(P...),
     }
     VIXL_ASSERT(GetSizeOfCodeGeneratedSince(&start) ==
                 kRuntimeCallWrapperOffset);
+    RecordRelocation(Relocation::kAbsolute64,
+                     GetCursorOffset(),
+                     runtime_call_wrapper_address);
     dc(runtime_call_wrapper_address);
     VIXL_ASSERT(GetSizeOfCodeGeneratedSince(&start) ==
                 kRuntimeCallFunctionOffset);
+    RecordRelocation(Relocation::kAbsolute64,
+                     GetCursorOffset(),
+                     function_address);
     dc(function_address);
     VIXL_ASSERT(GetSizeOfCodeGeneratedSince(&start) == kRuntimeCallTypeOffset);
     dc32(call_type);
@@ -7303,7 +7465,20 @@ void MacroAssembler::CallRuntimeHelper(R (*function)(P...),
   } else {
     UseScratchRegisterScope temps(this);
     Register temp = temps.AcquireX();
-    Mov(temp, reinterpret_cast<uint64_t>(function));
+    uint64_t function_address = reinterpret_cast<uint64_t>(function);
+    if (IsRecordingRelocations()) {
+      // Use a fixed-length sequence, so that the address can be patched.
+      ExactAssemblyScope scope(this, 4 * kInstructionSize);
+      RecordRelocation(Relocation::kMovWide64,
+                       GetCursorOffset(),
+                       function_address);
+      movz(temp, function_address & 0xffff, 0);
+      movk(temp, (function_address >> 16) & 0xffff, 16);
+      movk(temp, (function_address >> 32) & 0xffff, 32);
+      movk(temp, (function_address >> 48) & 0xffff, 48);
+    } else {
+      Mov(temp, function_address);
+    }
     if (call_type == kTailCallRuntime) {
       Br(temp);
     } else {
@@ -0,0 +1,89 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+
+#include "memory-trace-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+const char MemoryTraceHeader::kMagic[8] =
+    {'V', 'I', 'X', 'L', 'M', 'T', 'R', 'C'};
+
+
+MemoryTraceWriter::MemoryTraceWriter(FILE* stream, size_t buffer_size)
+    : stream_(stream),
+      buffer_(buffer_size),
+      buffered_count_(0),
+      written_count_(0),
+      error_(false) {
+  VIXL_ASSERT(buffer_size > 0);
+  MemoryTraceHeader header;
+  memcpy(header.magic, MemoryTraceHeader::kMagic, sizeof(header.magic));
+  header.version = MemoryTraceHeader::kVersion;
+  header.record_size = sizeof(MemoryTraceRecord);
+  if (fwrite(&header, sizeof(header), 1, stream_) != 1) error_ = true;
+}
+
+
+void MemoryTraceWriter::Flush() {
+  if (buffered_count_ == 0) return;
+  size_t written =
+      fwrite(buffer_.data(), sizeof(buffer_[0]), buffered_count_, stream_);
+  if (written != buffered_count_) error_ = true;
+  written_count_ += buffered_count_;
+  buffered_count_ = 0;
+}
+
+
+MemoryTraceReader::MemoryTraceReader(FILE* stream, size_t buffer_size)
+    : stream_(stream),
+      buffer_(buffer_size),
+      buffered_count_(0),
+      next_(0),
+      valid_(false) {
+  VIXL_ASSERT(buffer_size > 0);
+  MemoryTraceHeader header;
+  if (fread(&header, sizeof(header), 1, stream_) != 1) return;
+  valid_ = (memcmp(header.magic,
+                   MemoryTraceHeader::kMagic,
+                   sizeof(header.magic)) == 0) &&
+           (header.version == MemoryTraceHeader::kVersion) &&
+           (header.record_size == sizeof(MemoryTraceRecord));
+}
+
+
+bool MemoryTraceReader::Refill() {
+  if (!valid_) return false;
+  buffered_count_ =
+      fread(buffer_.data(), sizeof(buffer_[0]), buffer_.size(), stream_);
+  next_ = 0;
+  return buffered_count_ > 0;
+}
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,150 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VIXL_AARCH64_MEMORY_TRACE_AARCH64_H_
+#define VIXL_AARCH64_MEMORY_TRACE_AARCH64_H_
+
+#include <cstdio>
+#include <vector>
+
+#include "../globals-vixl.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// A binary trace of simulated data accesses, for offline analysis such as
+// cache simulation.
+//
+// A trace file starts with a MemoryTraceHeader, and is followed by a sequence
+// of fixed-width MemoryTraceRecords, in the order that the accesses were made.
+// Everything is stored in host byte order.
+//
+// The Simulator produces traces through a MemoryTraceWriter (see
+// Simulator::SetMemoryTrace()). MemoryTraceReader reads them back, and does
+// not depend on the Simulator, so analysis tools can use it on any host.
+
+struct MemoryTraceRecord {
+  enum Flags {
+    // The access was a store. Otherwise, it was a load.
+    kWrite = 1 << 0,
+    // The access was made by a NEON or SVE vector load or store.
+    kVector = 1 << 1,
+    // The access was made by an SVE gather load or scatter store.
+    kGather = 1 << 2
+  };
+
+  uint64_t pc;
+  uint64_t address;
+  uint32_t size;
+  uint32_t flags;
+
+  bool IsWrite() const { return (flags & kWrite) != 0; }
+  bool IsVector() const { return (flags & kVector) != 0; }
+  bool IsGather() const { return (flags & kGather) != 0; }
+};
+
+VIXL_STATIC_ASSERT(sizeof(MemoryTraceRecord) == 24);
+
+struct MemoryTraceHeader {
+  static const char kMagic[8];
+  static const uint32_t kVersion = 1;
+
+  char magic[8];
+  uint32_t version;
+  // sizeof(MemoryTraceRecord), so that readers can detect incompatible hosts.
+  uint32_t record_size;
+};
+
+// Write a trace to a stdio stream. Records are buffered, and only written
+// when the buffer is full, when Flush() is called, or on destruction.
+class MemoryTraceWriter {
+ public:
+  static const size_t kDefaultBufferSize = 4096;
+
+  // The stream is not closed by the writer. The header is written
+  // immediately.
+  explicit MemoryTraceWriter(FILE* stream,
+                             size_t buffer_size = kDefaultBufferSize);
+  ~MemoryTraceWriter() { Flush(); }
+
+  void Append(uint64_t pc, uint64_t address, uint32_t size, uint32_t flags) {
+    MemoryTraceRecord& record = buffer_[buffered_count_++];
+    record.pc = pc;
+    record.address = address;
+    record.size = size;
+    record.flags = flags;
+    if (buffered_count_ == buffer_.size()) Flush();
+  }
+
+  void Flush();
+
+  // The number of records appended so far, including any still buffered.
+  uint64_t GetRecordCount() const { return written_count_ + buffered_count_; }
+
+  // Return true if any write to the stream has failed.
+  bool HasError() const { return error_; }
+
+ private:
+  FILE* stream_;
+  std::vector<MemoryTraceRecord> buffer_;
+  size_t buffered_count_;
+  uint64_t written_count_;
+  bool error_;
+};
+
+// Read a trace from a stdio stream, a block of records at a time.
+class MemoryTraceReader {
+ public:
+  static const size_t kDefaultBufferSize = 4096;
+
+  // The stream is not closed by the reader. The header is read immediately;
+  // if it is not valid, IsValid() returns false, and no records are read.
+  explicit MemoryTraceReader(FILE* stream,
+                             size_t buffer_size = kDefaultBufferSize);
+
+  bool IsValid() const { return valid_; }
+
+  // Read the next record. Return false at the end of the trace.
+  bool Next(MemoryTraceRecord* record) {
+    if ((next_ == buffered_count_) && !Refill()) return false;
+    *record = buffer_[next_++];
+    return true;
+  }
+
+ private:
+  bool Refill();
+
+  FILE* stream_;
+  std::vector<MemoryTraceRecord> buffer_;
+  size_t buffered_count_;
+  size_t next_;
+  bool valid_;
+};
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_MEMORY_TRACE_AARCH64_H_
@@ -0,0 +1,125 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+
+#include "relocation-aarch64.h"
+
+#include "assembler-aarch64.h"
+#include "instructions-aarch64.h"
+
+namespace vixl {
+namespace aarch64 {
+
+static void RelocatePCRelativeExternal(Instruction* instr,
+                                       uintptr_t pc,
+                                       uint64_t target) {
+  // The instruction is patched where it was written, so express its target
+  // relative to that address rather than to `pc`.
+  int64_t offset = static_cast<int64_t>(target - pc);
+  const Instruction* patch_target = instr + offset;
+  if (instr->IsLoadLiteral()) {
+    VIXL_CHECK(IsMultiple(offset, kLiteralEntrySize));
+    VIXL_CHECK(IsInt19(offset / kLiteralEntrySize));
+    instr->SetImmLLiteral(patch_target);
+  } else if (instr->IsPCRelAddressing()) {
+    if (instr->Mask(PCRelAddressingMask) == ADRP) {
+      offset = static_cast<int64_t>((target / kPageSize) - (pc / kPageSize));
+    }
+    VIXL_CHECK(IsInt21(offset));
+    instr->SetImmPCOffsetTarget(patch_target);
+  } else {
+    VIXL_CHECK(IsMultiple(offset, kInstructionSize));
+    VIXL_CHECK(Instruction::IsValidImmPCOffset(instr->GetBranchType(),
+                                               offset / kInstructionSize));
+    instr->SetImmPCOffsetTarget(patch_target);
+  }
+}
+
+
+static void RelocateMovWide64(Instruction* instr, uint64_t target) {
+  for (int i = 0; i < 4; i++) {
+    Instruction* mov = instr + (i * kInstructionSize);
+    VIXL_ASSERT(mov->Mask(MoveWideImmediateMask) ==
+                ((i == 0) ? MOVZ_x : MOVK_x));
+    VIXL_ASSERT(mov->GetShiftMoveWide() == i);
+    uint64_t imm16 = (target >> (i * 16)) & 0xffff;
+    mov->SetInstructionBits(mov->Mask(~ImmMoveWide_mask) |
+                            Assembler::ImmMoveWide(imm16));
+  }
+}
+
+
+void RelocateCode(void* code,
+                  uintptr_t execution_address,
+                  size_t size,
+                  const std::vector<Relocation>& relocations) {
+  byte* base = static_cast<byte*>(code);
+  VIXL_ASSERT(IsAligned(execution_address, kInstructionSize));
+  VIXL_ASSERT(((reinterpret_cast<uintptr_t>(base) ^ execution_address) &
+               (kPageSize - 1)) == 0);
+  USE(size);
+
+  for (size_t i = 0; i < relocations.size(); i++) {
+    const Relocation& relocation = relocations[i];
+    VIXL_ASSERT((relocation.offset >= 0) &&
+                (static_cast<size_t>(relocation.offset) < size));
+    Instruction* instr =
+        reinterpret_cast<Instruction*>(base + relocation.offset);
+    switch (relocation.kind) {
+      case Relocation::kAdrpInternal:
+        VIXL_ASSERT(instr->Mask(PCRelAddressingMask) == ADRP);
+        VIXL_ASSERT(relocation.target < size);
+        instr->SetImmPCOffsetTarget(
+            reinterpret_cast<Instruction*>(base + relocation.target));
+        break;
+      case Relocation::kPCRelativeExternal:
+        RelocatePCRelativeExternal(instr,
+                                   execution_address + relocation.offset,
+                                   relocation.target);
+        break;
+      case Relocation::kAbsolute64:
+        memcpy(instr, &relocation.target, sizeof(relocation.target));
+        break;
+      case Relocation::kMovWide64:
+        RelocateMovWide64(instr, relocation.target);
+        break;
+    }
+  }
+}
+
+
+void CopyAndRelocateCode(void* destination,
+                         uintptr_t execution_address,
+                         const void* source,
+                         size_t size,
+                         const std::vector<Relocation>& relocations) {
+  memcpy(destination, source, size);
+  RelocateCode(destination, execution_address, size, relocations);
+}
+
+}  // namespace aarch64
+}  // namespace vixl
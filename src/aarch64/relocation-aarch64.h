@@ -0,0 +1,92 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VIXL_AARCH64_RELOCATION_AARCH64_H_
+#define VIXL_AARCH64_RELOCATION_AARCH64_H_
+
+#include <vector>
+
+#include "../globals-vixl.h"
+
+namespace vixl {
+namespace aarch64 {
+
+// A position-dependent site in generated code. The Assembler records these when
+// asked to (see Assembler::SetRecordRelocations()), so that the finished code
+// can be copied to, and run from, another address.
+//
+// Code that only refers to itself through Labels and literals is already
+// position-independent, so only a few kinds of site need relocations.
+struct Relocation {
+  enum Kind {
+    // An `adrp` whose target is in the same code. `target` is the offset of the
+    // target from the start of the code.
+    kAdrpInternal,
+    // A PC-relative branch, `adr`, `adrp` or literal load whose target is
+    // outside the code. `target` is the absolute target address.
+    kPCRelativeExternal,
+    // A 64-bit data word holding an absolute address, usually outside the code.
+    // `target` is the address.
+    kAbsolute64,
+    // A `movz`, `movk`, `movk`, `movk` sequence that materialises an absolute
+    // address, usually outside the code. `target` is the address.
+    kMovWide64
+  };
+
+  // The target of a kAdrpInternal relocation whose Label is not yet bound.
+  static const uint64_t kUnresolvedTarget = UINT64_MAX;
+
+  Kind kind;
+  // The offset of the site from the start of the code.
+  ptrdiff_t offset;
+  uint64_t target;
+};
+
+// Apply `relocations` to `size` bytes of code at `code`, so that it can be run
+// from `execution_address`. This is usually the same as `code`, but differs
+// when the code is written through a separate view, as in a dual-mapped
+// CodeBuffer. The two addresses must have the same offset into a page.
+//
+// Relocations only depend on the code's new address, so they can be applied to
+// any number of copies of the code, and to code that has already been
+// relocated.
+void RelocateCode(void* code,
+                  uintptr_t execution_address,
+                  size_t size,
+                  const std::vector<Relocation>& relocations);
+
+// Copy `size` bytes of code from `source` to `destination`, then relocate it as
+// RelocateCode() does.
+void CopyAndRelocateCode(void* destination,
+                         uintptr_t execution_address,
+                         const void* source,
+                         size_t size,
+                         const std::vector<Relocation>& relocations);
+
+}  // namespace aarch64
+}  // namespace vixl
+
+#endif  // VIXL_AARCH64_RELOCATION_AARCH64_H_
@@ -29,6 +29,8 @@
 #include <errno.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <limits>
@@ -67,14 +69,372 @@ SimSystemRegister SimSystemRegister::DefaultValueFor(SystemRegister id) {
 }
 
 
+void SimDirtyPageTracker::AddRange(uintptr_t base, size_t size) {
+  VIXL_ASSERT(size > 0);
+  for (const Range& range : ranges_) {
+    USE(range);
+    VIXL_ASSERT((base >= (range.base + range.size)) ||
+                ((base + size) <= range.base));
+  }
+  ranges_.push_back({base, size});
+  // Pages saved so far don't cover the new range.
+  last_saved_page_ = kNoPage;
+}
+
+
+void SimDirtyPageTracker::SavePage(uintptr_t page) {
+  last_saved_page_ = page;
+  if (saved_pages_.count(page) != 0) return;
+
+  uintptr_t page_start = page << kPageSizeLog2;
+  uintptr_t page_end = page_start + kPageSize;
+  std::vector<SavedChunk> chunks;
+  for (const Range& range : ranges_) {
+    uintptr_t start = std::max(page_start, range.base);
+    uintptr_t end = std::min(page_end, range.base + range.size);
+    if (start >= end) continue;
+    SavedChunk chunk;
+    chunk.address = start;
+    chunk.data.resize(end - start);
+    memcpy(chunk.data.data(),
+           reinterpret_cast<const void*>(start),
+           end - start);
+    chunks.push_back(std::move(chunk));
+  }
+  if (!chunks.empty()) dirty_page_count_++;
+  saved_pages_[page] = std::move(chunks);
+}
+
+
+void SimDirtyPageTracker::RestoreDirtyPages() {
+  for (const auto& page : saved_pages_) {
+    for (const SavedChunk& chunk : page.second) {
+      memcpy(reinterpret_cast<void*>(chunk.address),
+             chunk.data.data(),
+             chunk.data.size());
+    }
+  }
+  DiscardDirtyPages();
+}
+
+
+void SimGuestMemory::MapRegion(uint64_t guest_address,
+                               void* host,
+                               size_t size,
+                               int permissions) {
+  VIXL_ASSERT((permissions & ~kReadWrite) == 0);
+  VIXL_CHECK((size > 0) && ((guest_address + size - 1) >= guest_address));
+  // Check that the new region doesn't overlap its neighbours.
+  auto next = regions_.lower_bound(guest_address);
+  VIXL_CHECK((next == regions_.end()) ||
+             ((next->first - guest_address) >= size));
+  if (next != regions_.begin()) {
+    auto prev = std::prev(next);
+    VIXL_CHECK((guest_address - prev->first) >= prev->second.size);
+  }
+
+  Region& region = regions_[guest_address];
+  region.start = guest_address;
+  region.size = size;
+  region.host = static_cast<char*>(host);
+  region.permissions = permissions;
+  FlushTLB();
+}
+
+
+void* SimGuestMemory::AllocateRegion(uint64_t guest_address,
+                                     size_t size,
+                                     int permissions) {
+  std::unique_ptr<char[]> owned(new char[size]());
+  char* host = owned.get();
+  MapRegion(guest_address, host, size, permissions);
+  regions_[guest_address].owned = std::move(owned);
+  return host;
+}
+
+
+void SimGuestMemory::UnmapRegion(uint64_t guest_address) {
+  auto it = regions_.find(guest_address);
+  VIXL_CHECK(it != regions_.end());
+  uint64_t page_mask = ~static_cast<uint64_t>(kPageSize - 1);
+  uint64_t first_page = guest_address & page_mask;
+  uint64_t last_page = (guest_address + it->second.size - 1) & page_mask;
+  regions_.erase(it);
+  // Drop the copies of pages that no longer overlap any region.
+  for (uint64_t page = first_page; page <= last_page; page += kPageSize) {
+    if (copied_pages_.count(page) == 0) continue;
+    auto next = regions_.lower_bound(page);
+    bool mapped = (FindRegion(page) != NULL) ||
+                  ((next != regions_.end()) &&
+                   (next->first < (page + kPageSize)));
+    if (!mapped) copied_pages_.erase(page);
+  }
+  FlushTLB();
+}
+
+
+void SimGuestMemory::SetRegionPermissions(uint64_t guest_address,
+                                          int permissions) {
+  VIXL_ASSERT((permissions & ~kReadWrite) == 0);
+  auto it = regions_.find(guest_address);
+  VIXL_CHECK(it != regions_.end());
+  it->second.permissions = permissions;
+  FlushTLB();
+}
+
+
+char* SimGuestMemory::TranslateSlow(uint64_t address,
+                                    size_t size,
+                                    int access) {
+  VIXL_ASSERT((access == kRead) || (access == kWrite));
+  uint64_t page = address & ~static_cast<uint64_t>(kPageSize - 1);
+  uint64_t offset = address - page;
+  if ((size == 0) || ((offset + size) > kPageSize)) return NULL;
+
+  Region* region = FindRegion(address);
+  if ((region == NULL) || ((region->permissions & access) == 0)) return NULL;
+  uint64_t region_start = region->start;
+  if ((address - region_start + size) > region->size) return NULL;
+
+  char* copy = NULL;
+  auto copied = copied_pages_.find(page);
+  if (copied != copied_pages_.end()) {
+    copy = copied->second.get();
+  } else if (snapshot_active_ && (access == kWrite)) {
+    copy = CopyPage(page);
+  }
+
+  // Cache the translation if the whole page belongs to this region.
+  if ((page >= region_start) &&
+      ((page - region_start + kPageSize) <= region->size)) {
+    TLBEntry& entry = tlb_[(address >> kPageSizeLog2) & kTLBMask];
+    bool writable = ((region->permissions & kWrite) != 0) &&
+                    (!snapshot_active_ || (copy != NULL));
+    entry.read_tag = ((region->permissions & kRead) != 0) ? page : kInvalidTag;
+    entry.write_tag = writable ? page : kInvalidTag;
+    entry.host = (copy != NULL) ? copy : region->host + (page - region_start);
+  }
+
+  if (copy != NULL) return copy + offset;
+  return region->host + (address - region_start);
+}
+
+
+SimGuestMemory::Region* SimGuestMemory::FindRegion(uint64_t address) {
+  auto it = regions_.upper_bound(address);
+  if (it == regions_.begin()) return NULL;
+  --it;
+  if ((address - it->first) >= it->second.size) return NULL;
+  return &it->second;
+}
+
+
+bool SimGuestMemory::Read(uint64_t address, void* dst, size_t size) {
+  char* out = static_cast<char*>(dst);
+  while (size > 0) {
+    uint64_t offset = address & (kPageSize - 1);
+    size_t chunk = std::min<uint64_t>(size, kPageSize - offset);
+    const char* host = Translate(address, chunk, kRead);
+    if (host == NULL) return false;
+    memcpy(out, host, chunk);
+    address += chunk;
+    out += chunk;
+    size -= chunk;
+  }
+  return true;
+}
+
+
+bool SimGuestMemory::Write(uint64_t address,
+                           const void* src,
+                           size_t size,
+                           SimDirtyPageTracker* tracker) {
+  const char* in = static_cast<const char*>(src);
+  while (size > 0) {
+    uint64_t offset = address & (kPageSize - 1);
+    size_t chunk = std::min<uint64_t>(size, kPageSize - offset);
+    char* host = Translate(address, chunk, kWrite);
+    if (host == NULL) return false;
+    if (tracker != NULL) {
+      tracker->NotifyWrite(reinterpret_cast<uintptr_t>(host), chunk);
+    }
+    memcpy(host, in, chunk);
+    address += chunk;
+    in += chunk;
+    size -= chunk;
+  }
+  return true;
+}
+
+
+bool SimGuestMemory::IsAccessible(uint64_t address, size_t size, int access) {
+  while (size > 0) {
+    uint64_t offset = address & (kPageSize - 1);
+    size_t chunk = std::min<uint64_t>(size, kPageSize - offset);
+    if (Translate(address, chunk, access) == NULL) return false;
+    address += chunk;
+    size -= chunk;
+  }
+  return true;
+}
+
+
+void SimGuestMemory::TakeSnapshot() {
+  if (snapshot_active_) DiscardSnapshot();
+  snapshot_active_ = true;
+  // Drop the cached write permissions, so that the next write to each page
+  // makes a copy.
+  FlushTLB();
+}
+
+
+void SimGuestMemory::RestoreSnapshot() {
+  VIXL_ASSERT(snapshot_active_);
+  copied_pages_.clear();
+  FlushTLB();
+}
+
+
+void SimGuestMemory::DiscardSnapshot() {
+  for (const auto& page : copied_pages_) {
+    CopyCoveredBytes(page.first, page.second.get(), true);
+  }
+  copied_pages_.clear();
+  snapshot_active_ = false;
+  FlushTLB();
+}
+
+
+char* SimGuestMemory::CopyPage(uint64_t page) {
+  std::unique_ptr<char[]> copy(new char[kPageSize]());
+  CopyCoveredBytes(page, copy.get(), false);
+  char* result = copy.get();
+  copied_pages_[page] = std::move(copy);
+  return result;
+}
+
+
+void SimGuestMemory::CopyCoveredBytes(uint64_t page, char* copy, bool to_host) {
+  // Start with the region containing the start of the page, if there is one.
+  auto it = regions_.upper_bound(page);
+  if (it != regions_.begin()) --it;
+  for (; (it != regions_.end()) && (it->first < (page + kPageSize)); ++it) {
+    uint64_t start = std::max(page, it->first);
+    uint64_t end = std::min(page + kPageSize, it->first + it->second.size);
+    if (start >= end) continue;
+    char* host = it->second.host + (start - it->first);
+    if (to_host) {
+      memcpy(host, copy + (start - page), end - start);
+    } else {
+      memcpy(copy + (start - page), host, end - start);
+    }
+  }
+}
+
+
+void SimGuestMemory::FlushTLB() {
+  for (TLBEntry& entry : tlb_) {
+    entry.read_tag = kInvalidTag;
+    entry.write_tag = kInvalidTag;
+    entry.host = NULL;
+  }
+}
+
+
+void SimWatchpoints::Add(uint64_t address,
+                         size_t size,
+                         int access,
+                         bool stop) {
+  VIXL_ASSERT(size > 0);
+  VIXL_ASSERT((access & ~kReadWrite) == 0);
+  Range range = {address, size, access, stop};
+  ranges_.push_back(range);
+  AddToFilter(range);
+}
+
+
+void SimWatchpoints::Remove(uint64_t address) {
+  ranges_.erase(std::remove_if(ranges_.begin(),
+                               ranges_.end(),
+                               [address](const Range& range) {
+                                 return range.address == address;
+                               }),
+                ranges_.end());
+  // Filter bits can be shared, so rebuild the filter from scratch.
+  memset(filter_, 0, sizeof(filter_));
+  for (const Range& range : ranges_) AddToFilter(range);
+}
+
+
+const uint64_t SimWatchpoints::kFilterMask;
+
+
+void SimWatchpoints::Clear() {
+  ranges_.clear();
+  memset(filter_, 0, sizeof(filter_));
+}
+
+
+void SimWatchpoints::AddToFilter(const Range& range) {
+  uint64_t page = range.address >> kPageSizeLog2;
+  uint64_t last_page = (range.address + range.size - 1) >> kPageSizeLog2;
+  // Once every bit is set, there is no point in looking at more pages.
+  uint64_t page_count = std::min(last_page - page, kFilterMask) + 1;
+  for (uint64_t i = 0; i < page_count; i++) {
+    uint64_t bit = (page + i) & kFilterMask;
+    filter_[bit / 64] |= UINT64_C(1) << (bit % 64);
+  }
+}
+
+
+void SimWatchpoints::Check(uint64_t pc,
+                           uint64_t address,
+                           const void* data,
+                           size_t size,
+                           int access) {
+  bool hit = false;
+  for (const Range& range : ranges_) {
+    if ((range.access & access) == 0) continue;
+    // Check for overlap, taking care not to overflow.
+    if (((address - range.address) < range.size) ||
+        ((range.address - address) < size)) {
+      hit = true;
+      if (range.stop) stop_requested_ = true;
+    }
+  }
+  if (!hit) return;
+
+  SimWatchpointHit record;
+  record.pc = pc;
+  record.address = address;
+  record.value = 0;
+  memcpy(&record.value, data, std::min(size, sizeof(record.value)));
+  record.size = static_cast<uint32_t>(size);
+  record.access = access;
+  if (log_.size() < log_capacity_) {
+    log_.push_back(record);
+  } else {
+    log_[hit_count_ % log_capacity_] = record;
+  }
+  hit_count_++;
+}
+
+
 Simulator::Simulator(Decoder* decoder, FILE* stream, SimStack::Allocated stack)
     : memory_(std::move(stack)),
+      memory_trace_(NULL),
+      runtime_call_timing_(false),
       movprfx_(NULL),
       cpu_features_auditor_(decoder, CPUFeatures::All()) {
   // Ensure that shift operations act as the simulator expects.
   VIXL_ASSERT((static_cast<int32_t>(-1) >> 1) == -1);
   VIXL_ASSERT((static_cast<uint32_t>(-1) >> 1) == 0x7fffffff);
 
+  // Checkpoints always cover the usable part of the stack.
+  const char* stack_limit = memory_.GetStack().GetLimit() + 1;
+  const char* stack_base = memory_.GetStack().GetBase();
+  RegisterCheckpointMemory(stack_limit, stack_base - stack_limit);
+
   // Set up a placeholder pipe for CanReadMemory.
   VIXL_CHECK(pipe(placeholder_pipe_fd_) == 0);
 
@@ -97,6 +457,33 @@ Simulator::Simulator(Decoder* decoder, FILE* stream, SimStack::Allocated stack)
   SetColouredTrace(false);
   trace_parameters_ = LOG_NONE;
 
+  // Set up lazy resets for SVE/FP registers, so that the cost of resetting
+  // them doesn't depend on the vector length.
+  vregister_reset_generation_ = 0;
+  for (unsigned i = 0; i < kNumberOfZRegisters; i++) {
+    // Set SVE/FP registers to a value that is a NaN in both 32-bit and 64-bit
+    // FP. Encode the register number and (D-sized) lane into each NaN, to
+    // make them easier to trace.
+    uint64_t nan_bits = 0x7ff0f0007f80f000 | (0x0000000100000000 * i);
+    VIXL_ASSERT(IsSignallingNaN(RawbitsToDouble(nan_bits & kDRegMask)));
+    VIXL_ASSERT(IsSignallingNaN(RawbitsToFloat(nan_bits & kSRegMask)));
+    vregisters_[i].SetLazyReset(&vregister_reset_generation_,
+                                kDRegSizeInBytes,
+                                nan_bits,
+                                0x0000000000000001);
+  }
+  pregister_reset_generation_ = 0;
+  // Ensure the register configuration fits in this bit encoding.
+  VIXL_STATIC_ASSERT(kNumberOfPRegisters <= UINT8_MAX);
+  VIXL_ASSERT((kPRegMaxSizeInBytes / kHRegSizeInBytes) <= UINT8_MAX);
+  for (unsigned i = 0; i < kNumberOfPRegisters; i++) {
+    // Encode the register number and (H-sized) lane into each lane slot.
+    pregisters_[i].SetLazyReset(&pregister_reset_generation_,
+                                kHRegSizeInBytes,
+                                i,
+                                0x0100);
+  }
+
   // We have to configure the SVE vector register length before calling
   // ResetState().
   SetVectorLengthInBits(kZRegMinSize);
@@ -123,6 +510,7 @@ Simulator::Simulator(Decoder* decoder, FILE* stream, SimStack::Allocated stack)
 void Simulator::ResetSystemRegisters() {
   // Reset the system registers.
   nzcv_ = SimSystemRegister::DefaultValueFor(NZCV);
+  lazy_nzcv_.source = LazyNzcv::kNone;
   fpcr_ = SimSystemRegister::DefaultValueFor(FPCR);
   ResetFFR();
 }
@@ -136,38 +524,15 @@ void Simulator::ResetRegisters() {
 }
 
 void Simulator::ResetVRegisters() {
-  // Set SVE/FP registers to a value that is a NaN in both 32-bit and 64-bit FP.
-  VIXL_ASSERT((GetVectorLengthInBytes() % kDRegSizeInBytes) == 0);
-  int lane_count = GetVectorLengthInBytes() / kDRegSizeInBytes;
-  for (unsigned i = 0; i < kNumberOfZRegisters; i++) {
-    VIXL_ASSERT(vregisters_[i].GetSizeInBytes() == GetVectorLengthInBytes());
-    vregisters_[i].NotifyAccessAsZ();
-    for (int lane = 0; lane < lane_count; lane++) {
-      // Encode the register number and (D-sized) lane into each NaN, to
-      // make them easier to trace.
-      uint64_t nan_bits = 0x7ff0f0007f80f000 | (0x0000000100000000 * i) |
-                          (0x0000000000000001 * lane);
-      VIXL_ASSERT(IsSignallingNaN(RawbitsToDouble(nan_bits & kDRegMask)));
-      VIXL_ASSERT(IsSignallingNaN(RawbitsToFloat(nan_bits & kSRegMask)));
-      vregisters_[i].Insert(lane, nan_bits);
-    }
-  }
+  // The registers are reset lazily. The reset values are set up in the
+  // constructor.
+  vregister_reset_generation_++;
 }
 
 void Simulator::ResetPRegisters() {
-  VIXL_ASSERT((GetPredicateLengthInBytes() % kHRegSizeInBytes) == 0);
-  int lane_count = GetPredicateLengthInBytes() / kHRegSizeInBytes;
-  // Ensure the register configuration fits in this bit encoding.
-  VIXL_STATIC_ASSERT(kNumberOfPRegisters <= UINT8_MAX);
-  VIXL_ASSERT(lane_count <= UINT8_MAX);
-  for (unsigned i = 0; i < kNumberOfPRegisters; i++) {
-    VIXL_ASSERT(pregisters_[i].GetSizeInBytes() == GetPredicateLengthInBytes());
-    for (int lane = 0; lane < lane_count; lane++) {
-      // Encode the register number and (H-sized) lane into each lane slot.
-      uint16_t bits = (0x0100 * lane) | i;
-      pregisters_[i].Insert(lane, bits);
-    }
-  }
+  // The registers are reset lazily. The reset values are set up in the
+  // constructor.
+  pregister_reset_generation_++;
 }
 
 void Simulator::ResetFFR() {
@@ -186,12 +551,24 @@ void Simulator::ResetState() {
 
   pc_ = NULL;
   pc_modified_ = false;
+  executed_instruction_count_ = 0;
+  memset(&gather_scatter_stats_, 0, sizeof(gather_scatter_stats_));
+  stopped_at_watchpoint_ = false;
+  // The cache points into the statistics, so they are cleared together.
+  InvalidateRuntimeCallCache();
+  runtime_call_stats_.clear();
 
   // BTI state.
   btype_ = DefaultBType;
   next_btype_ = DefaultBType;
 }
 
+void Simulator::InvalidateRuntimeCallCache() {
+  for (int i = 0; i < kRuntimeCallCacheSize; i++) {
+    runtime_call_cache_[i].pc = NULL;
+  }
+}
+
 void Simulator::SetVectorLengthInBits(unsigned vector_length) {
   VIXL_ASSERT((vector_length >= kZRegMinSize) &&
               (vector_length <= kZRegMaxSize));
@@ -212,6 +589,112 @@ void Simulator::SetVectorLengthInBits(unsigned vector_length) {
   ResetFFR();
 }
 
+void Simulator::SaveCheckpoint() {
+  if (checkpoint_ == NULL) checkpoint_ = std::make_unique<SimCheckpoint>();
+  SimCheckpoint* checkpoint = checkpoint_.get();
+
+  for (unsigned i = 0; i < kNumberOfRegisters; i++) {
+    checkpoint->registers[i] = registers_[i];
+  }
+
+  checkpoint->vector_length = vector_length_;
+  int z_lanes = GetVectorLengthInBytes() / kDRegSizeInBytes;
+  checkpoint->z_registers.resize(kNumberOfZRegisters * z_lanes);
+  for (unsigned i = 0; i < kNumberOfZRegisters; i++) {
+    for (int lane = 0; lane < z_lanes; lane++) {
+      checkpoint->z_registers[(i * z_lanes) + lane] =
+          vregisters_[i].GetLane<uint64_t>(lane);
+    }
+  }
+  int p_lanes = GetPredicateLengthInBytes() / kHRegSizeInBytes;
+  checkpoint->p_registers.resize(kNumberOfPRegisters * p_lanes);
+  checkpoint->ffr_register.resize(p_lanes);
+  for (int lane = 0; lane < p_lanes; lane++) {
+    for (unsigned i = 0; i < kNumberOfPRegisters; i++) {
+      checkpoint->p_registers[(i * p_lanes) + lane] =
+          pregisters_[i].GetLane<uint16_t>(lane);
+    }
+    checkpoint->ffr_register[lane] = ffr_register_.GetLane<uint16_t>(lane);
+  }
+
+  checkpoint->nzcv = ReadNzcv();
+  checkpoint->fpcr = fpcr_;
+  checkpoint->pc = pc_;
+  checkpoint->btype = btype_;
+  checkpoint->next_btype = next_btype_;
+  memcpy(checkpoint->rand_state, rand_state_, sizeof(rand_state_));
+  checkpoint->executed_instruction_count = executed_instruction_count_;
+
+  memory_.SetDirtyPageTracker(&dirty_page_tracker_);
+  dirty_page_tracker_.Enable();
+}
+
+void Simulator::RestoreCheckpoint() {
+  VIXL_ASSERT(HasCheckpoint());
+  const SimCheckpoint* checkpoint = checkpoint_.get();
+
+  for (unsigned i = 0; i < kNumberOfRegisters; i++) {
+    registers_[i] = checkpoint->registers[i];
+  }
+
+  if (vector_length_ != checkpoint->vector_length) {
+    SetVectorLengthInBits(checkpoint->vector_length);
+  }
+  int z_lanes = GetVectorLengthInBytes() / kDRegSizeInBytes;
+  for (unsigned i = 0; i < kNumberOfZRegisters; i++) {
+    for (int lane = 0; lane < z_lanes; lane++) {
+      vregisters_[i].Insert(lane,
+                            checkpoint->z_registers[(i * z_lanes) + lane]);
+    }
+  }
+  int p_lanes = GetPredicateLengthInBytes() / kHRegSizeInBytes;
+  for (int lane = 0; lane < p_lanes; lane++) {
+    for (unsigned i = 0; i < kNumberOfPRegisters; i++) {
+      pregisters_[i].Insert(lane,
+                            checkpoint->p_registers[(i * p_lanes) + lane]);
+    }
+    ffr_register_.Insert(lane, checkpoint->ffr_register[lane]);
+  }
+
+  nzcv_ = checkpoint->nzcv;
+  lazy_nzcv_.source = LazyNzcv::kNone;
+  fpcr_ = checkpoint->fpcr;
+  pc_ = checkpoint->pc;
+  pc_modified_ = false;
+  movprfx_ = NULL;
+  btype_ = checkpoint->btype;
+  next_btype_ = checkpoint->next_btype;
+  memcpy(rand_state_, checkpoint->rand_state, sizeof(rand_state_));
+  executed_instruction_count_ = checkpoint->executed_instruction_count;
+  local_monitor_.Clear();
+
+  dirty_page_tracker_.RestoreDirtyPages();
+}
+
+void Simulator::DiscardCheckpoint() {
+  checkpoint_.reset();
+  dirty_page_tracker_.Disable();
+  memory_.SetDirtyPageTracker(NULL);
+}
+
+void Simulator::SetGuestMemory(SimGuestMemory* guest_memory) {
+  if (guest_memory != NULL) {
+    char* stack_limit = memory_.GetStack().GetLimit() + 1;
+    char* stack_base = memory_.GetStack().GetBase();
+    uint64_t stack_address = reinterpret_cast<uintptr_t>(stack_limit);
+    size_t stack_size = stack_base - stack_limit;
+    if (!guest_memory->IsAccessible(stack_address,
+                                    stack_size,
+                                    SimGuestMemory::kRead)) {
+      guest_memory->MapRegion(stack_address,
+                              stack_limit,
+                              stack_size,
+                              SimGuestMemory::kReadWrite);
+    }
+  }
+  memory_.SetGuestMemory(guest_memory);
+}
+
 Simulator::~Simulator() {
   // The decoder may outlive the simulator.
   decoder_->RemoveVisitor(print_disasm_);
@@ -226,12 +709,41 @@ void Simulator::Run() {
   // manually-set registers are logged _before_ the first instruction.
   LogAllWrittenRegisters();
 
+  stopped_at_watchpoint_ = false;
   while (pc_ != kEndOfSimAddress) {
     ExecuteInstruction();
+    executed_instruction_count_++;
+    if ((watchpoints_ != NULL) && watchpoints_->ConsumeStopRequest()) {
+      stopped_at_watchpoint_ = true;
+      break;
+    }
   }
 }
 
 
+bool Simulator::RunFor(uint64_t instruction_budget) {
+  // Flush any written registers before executing anything, so that
+  // manually-set registers are logged _before_ the first instruction.
+  LogAllWrittenRegisters();
+
+  uint64_t limit = executed_instruction_count_ + instruction_budget;
+  stopped_at_watchpoint_ = false;
+  while (pc_ != kEndOfSimAddress) {
+    ExecuteInstruction();
+    executed_instruction_count_++;
+    if ((watchpoints_ != NULL) && watchpoints_->ConsumeStopRequest()) {
+      stopped_at_watchpoint_ = true;
+      break;
+    }
+    // Only check the budget at the end of a basic block. `pc_modified_` is
+    // already tested for every instruction (by IncrementPc()), so this adds
+    // almost nothing to straight-line code.
+    if (pc_modified_ && (executed_instruction_count_ >= limit)) break;
+  }
+  return IsFinished();
+}
+
+
 void Simulator::RunFrom(const Instruction* first) {
   WritePc(first, NoBranchLog);
   Run();
@@ -450,22 +962,42 @@ uint64_t Simulator::AddWithCarry(unsigned reg_size,
   VIXL_ASSERT((carry_in == 0) || (carry_in == 1));
   VIXL_ASSERT((reg_size == kXRegSize) || (reg_size == kWRegSize));
 
-  uint64_t max_uint = (reg_size == kWRegSize) ? kWMaxUInt : kXMaxUInt;
   uint64_t reg_mask = (reg_size == kWRegSize) ? kWRegMask : kXRegMask;
-  uint64_t sign_mask = (reg_size == kWRegSize) ? kWSignMask : kXSignMask;
 
   left &= reg_mask;
   right &= reg_mask;
   uint64_t result = (left + right + carry_in) & reg_mask;
 
   if (set_flags) {
-    ReadNzcv().SetN(CalcNFlag(result, reg_size));
-    ReadNzcv().SetZ(CalcZFlag(result));
+    SetLazyNzcv(LazyNzcv::kAddWithCarry,
+                reg_size,
+                result,
+                left,
+                right,
+                carry_in);
+    LogSystemRegister(NZCV);
+  }
+  return result;
+}
+
+
+void Simulator::MaterialiseNzcv() const {
+  unsigned reg_size = lazy_nzcv_.reg_size;
+  uint64_t result = lazy_nzcv_.result;
+  nzcv_.SetN(CalcNFlag(result, reg_size));
+  nzcv_.SetZ(CalcZFlag(result));
+
+  if (lazy_nzcv_.source == LazyNzcv::kAddWithCarry) {
+    uint64_t max_uint = (reg_size == kWRegSize) ? kWMaxUInt : kXMaxUInt;
+    uint64_t sign_mask = (reg_size == kWRegSize) ? kWSignMask : kXSignMask;
+    uint64_t left = lazy_nzcv_.left;
+    uint64_t right = lazy_nzcv_.right;
+    int carry_in = lazy_nzcv_.carry_in;
 
     // Compute the C flag by comparing the result to the max unsigned integer.
     uint64_t max_uint_2op = max_uint - carry_in;
     bool C = (left > max_uint_2op) || ((max_uint_2op - left) < right);
-    ReadNzcv().SetC(C ? 1 : 0);
+    nzcv_.SetC(C ? 1 : 0);
 
     // Overflow iff the sign bit is the same for the two inputs and different
     // for the result.
@@ -473,11 +1005,13 @@ uint64_t Simulator::AddWithCarry(unsigned reg_size,
     uint64_t right_sign = right & sign_mask;
     uint64_t result_sign = result & sign_mask;
     bool V = (left_sign == right_sign) && (left_sign != result_sign);
-    ReadNzcv().SetV(V ? 1 : 0);
-
-    LogSystemRegister(NZCV);
+    nzcv_.SetV(V ? 1 : 0);
+  } else {
+    VIXL_ASSERT(lazy_nzcv_.source == LazyNzcv::kLogical);
+    nzcv_.SetC(0);
+    nzcv_.SetV(0);
   }
-  return result;
+  lazy_nzcv_.source = LazyNzcv::kNone;
 }
 
 
@@ -1919,10 +2453,7 @@ void Simulator::LogicalHelper(const Instruction* instr, int64_t op2) {
   }
 
   if (update_flags) {
-    ReadNzcv().SetN(CalcNFlag(result, reg_size));
-    ReadNzcv().SetZ(CalcZFlag(result));
-    ReadNzcv().SetC(0);
-    ReadNzcv().SetV(0);
+    SetLazyNzcv(LazyNzcv::kLogical, reg_size, result);
     LogSystemRegister(NZCV);
   }
 
@@ -2515,12 +3046,31 @@ void Simulator::CompareAndSwapPairHelper(const Instruction* instr) {
 }
 
 bool Simulator::CanReadMemory(uintptr_t address, size_t size) {
+  // Guest memory can be checked directly.
+  SimGuestMemory* guest_memory = memory_.GetGuestMemory();
+  if (guest_memory != NULL) {
+    return guest_memory->IsAccessible(memory_.AddressUntag(address),
+                                      size,
+                                      SimGuestMemory::kRead);
+  }
+
   // To simulate fault-tolerant loads, we need to know what host addresses we
   // can access without generating a real fault. One way to do that is to
   // attempt to `write()` the memory to a placeholder pipe[1]. This is more
   // portable and less intrusive than using (global) signal handlers.
   //
   // [1]: https://stackoverflow.com/questions/7134590
+  //
+  // That costs at least two system calls. The usable part of the simulated
+  // stack belongs to the simulator, and stays mapped for its lifetime, so
+  // accesses to it don't need a probe.
+  const SimStack::Allocated& stack = memory_.GetStack();
+  uintptr_t stack_limit = reinterpret_cast<uintptr_t>(stack.GetLimit() + 1);
+  uintptr_t stack_base = reinterpret_cast<uintptr_t>(stack.GetBase());
+  if ((address >= stack_limit) && (address < stack_base) &&
+      (size <= (stack_base - address))) {
+    return true;
+  }
 
   size_t written = 0;
   bool can_read = true;
@@ -8778,7 +9328,7 @@ void Simulator::VisitSVEIntArithmeticUnpredicated(const Instruction* instr) {
   SimVRegister& zm = ReadVRegister(instr->GetRm());
   switch (instr->Mask(SVEIntArithmeticUnpredicatedMask)) {
     case ADD_z_zz:
-      add(vform, zd, zn, zm);
+      SVEAddSubUnpredicatedHelper(ADD, vform, zd, zn, zm);
       break;
     case SQADD_z_zz:
       add(vform, zd, zn, zm).SignedSaturate(vform);
@@ -8787,7 +9337,7 @@ void Simulator::VisitSVEIntArithmeticUnpredicated(const Instruction* instr) {
       sub(vform, zd, zn, zm).SignedSaturate(vform);
       break;
     case SUB_z_zz:
-      sub(vform, zd, zn, zm);
+      SVEAddSubUnpredicatedHelper(SUB, vform, zd, zn, zm);
       break;
     case UQADD_z_zz:
       add(vform, zd, zn, zm).UnsignedSaturate(vform);
@@ -8811,13 +9361,13 @@ void Simulator::VisitSVEIntAddSubtractVectors_Predicated(
 
   switch (instr->Mask(SVEIntAddSubtractVectors_PredicatedMask)) {
     case ADD_z_p_zz:
-      add(vform, result, zdn, zm);
+      SVEAddSubUnpredicatedHelper(ADD, vform, result, zdn, zm);
       break;
     case SUBR_z_p_zz:
-      sub(vform, result, zm, zdn);
+      SVEAddSubUnpredicatedHelper(SUB, vform, result, zm, zdn);
       break;
     case SUB_z_p_zz:
-      sub(vform, result, zdn, zm);
+      SVEAddSubUnpredicatedHelper(SUB, vform, result, zdn, zm);
       break;
     default:
       VIXL_UNIMPLEMENTED();
@@ -9002,34 +9552,60 @@ void Simulator::VisitSVEIntCompareScalarCountAndLimit(
   int64_t ssrc2 = is_64_bit ? ReadXRegister(rm_code) : ReadWRegister(rm_code);
   uint64_t usrc2 = ssrc2 & mask;
 
-  bool last = true;
-  for (int lane = 0; lane < LaneCountFromFormat(vform); lane++) {
-    usrc1 &= mask;
-    int64_t ssrc1 = ExtractSignedBitfield64(rsize - 1, 0, usrc1);
+  usrc1 &= mask;
+  int64_t ssrc1 = ExtractSignedBitfield64(rsize - 1, 0, usrc1);
 
-    bool cond = false;
-    switch (instr->Mask(SVEIntCompareScalarCountAndLimitMask)) {
-      case WHILELE_p_p_rr:
-        cond = ssrc1 <= ssrc2;
-        break;
-      case WHILELO_p_p_rr:
-        cond = usrc1 < usrc2;
-        break;
-      case WHILELS_p_p_rr:
-        cond = usrc1 <= usrc2;
-        break;
-      case WHILELT_p_p_rr:
-        cond = ssrc1 < ssrc2;
-        break;
-      default:
-        VIXL_UNIMPLEMENTED();
-        break;
+  // The first lane for which the condition fails terminates the sequence, so
+  // rather than testing each lane, work out how many leading lanes are active.
+  // The difference is computed modulo 2^64, but it is always non-negative when
+  // the first lane is active, so it is correct even for 64-bit operands.
+  //
+  // For the inclusive conditions, the counter wraps around without failing the
+  // condition if the limit is the largest representable value, so every lane
+  // is active.
+  bool first_active = false;
+  bool inclusive = false;
+  bool unlimited = false;
+  uint64_t difference = 0;
+  switch (instr->Mask(SVEIntCompareScalarCountAndLimitMask)) {
+    case WHILELE_p_p_rr:
+      first_active = ssrc1 <= ssrc2;
+      inclusive = true;
+      unlimited = ssrc2 == static_cast<int64_t>(mask >> 1);
+      difference = static_cast<uint64_t>(ssrc2) - static_cast<uint64_t>(ssrc1);
+      break;
+    case WHILELO_p_p_rr:
+      first_active = usrc1 < usrc2;
+      difference = usrc2 - usrc1;
+      break;
+    case WHILELS_p_p_rr:
+      first_active = usrc1 <= usrc2;
+      inclusive = true;
+      unlimited = usrc2 == mask;
+      difference = usrc2 - usrc1;
+      break;
+    case WHILELT_p_p_rr:
+      first_active = ssrc1 < ssrc2;
+      difference = static_cast<uint64_t>(ssrc2) - static_cast<uint64_t>(ssrc1);
+      break;
+    default:
+      VIXL_UNIMPLEMENTED();
+      break;
+  }
+
+  uint64_t lane_count = LaneCountFromFormat(vform);
+  uint64_t active_count = 0;
+  if (first_active) {
+    if (unlimited) {
+      active_count = lane_count;
+    } else if (inclusive) {
+      active_count = (difference >= (lane_count - 1)) ? lane_count
+                                                       : (difference + 1);
+    } else {
+      active_count = std::min(difference, lane_count);
     }
-    last = last && cond;
-    LogicPRegister dst(pd);
-    dst.SetActive(vform, lane, last);
-    usrc1++;
   }
+  SetLeadingActiveLanes(vform, pd, static_cast<int>(active_count));
 
   PredTest(vform, GetPTrue(), pd);
   LogSystemRegister(NZCV);
@@ -9764,9 +10340,9 @@ void Simulator::VisitSVELoadPredicateRegister(const Instruction* instr) {
       int imm9 = (instr->ExtractBits(21, 16) << 3) | instr->ExtractBits(12, 10);
       uint64_t multiplier = ExtractSignedBitfield64(8, 0, imm9);
       uint64_t address = ReadXRegister(instr->GetRn()) + multiplier * pl;
-      for (int i = 0; i < pl; i++) {
-        pt.Insert(i, MemRead<uint8_t>(address + i));
-      }
+      uint8_t data[kZRegMaxSizeInBytes];
+      MemReadBlock(address, data, pl, MemoryTraceRecord::kVector);
+      pt.WriteLanes(data, pl);
       LogPRead(instr->GetPt(), address);
       break;
     }
@@ -9784,9 +10360,9 @@ void Simulator::VisitSVELoadVectorRegister(const Instruction* instr) {
       int imm9 = (instr->ExtractBits(21, 16) << 3) | instr->ExtractBits(12, 10);
       uint64_t multiplier = ExtractSignedBitfield64(8, 0, imm9);
       uint64_t address = ReadXRegister(instr->GetRn()) + multiplier * vl;
-      for (int i = 0; i < vl; i++) {
-        zt.Insert(i, MemRead<uint8_t>(address + i));
-      }
+      uint8_t data[kZRegMaxSizeInBytes];
+      MemReadBlock(address, data, vl, MemoryTraceRecord::kVector);
+      zt.WriteLanes(data, vl);
       LogZRead(instr->GetRt(), address);
       break;
     }
@@ -10719,9 +11295,9 @@ void Simulator::VisitSVEStorePredicateRegister(const Instruction* instr) {
       int imm9 = (instr->ExtractBits(21, 16) << 3) | instr->ExtractBits(12, 10);
       uint64_t multiplier = ExtractSignedBitfield64(8, 0, imm9);
       uint64_t address = ReadXRegister(instr->GetRn()) + multiplier * pl;
-      for (int i = 0; i < pl; i++) {
-        MemWrite(address + i, pt.GetLane<uint8_t>(i));
-      }
+      uint8_t data[kZRegMaxSizeInBytes];
+      pt.ReadLanes(data, pl);
+      MemWriteBlock(address, data, pl, MemoryTraceRecord::kVector);
       LogPWrite(instr->GetPt(), address);
       break;
     }
@@ -10739,9 +11315,9 @@ void Simulator::VisitSVEStoreVectorRegister(const Instruction* instr) {
       int imm9 = (instr->ExtractBits(21, 16) << 3) | instr->ExtractBits(12, 10);
       uint64_t multiplier = ExtractSignedBitfield64(8, 0, imm9);
       uint64_t address = ReadXRegister(instr->GetRn()) + multiplier * vl;
-      for (int i = 0; i < vl; i++) {
-        MemWrite(address + i, zt.GetLane<uint8_t>(i));
-      }
+      uint8_t data[kZRegMaxSizeInBytes];
+      zt.ReadLanes(data, vl);
+      MemWriteBlock(address, data, vl, MemoryTraceRecord::kVector);
       LogZWrite(instr->GetRt(), address);
       break;
     }
@@ -11902,21 +12478,58 @@ void Simulator::DoPrintf(const Instruction* instr) {
 void Simulator::DoRuntimeCall(const Instruction* instr) {
   VIXL_STATIC_ASSERT(kRuntimeCallAddressSize == sizeof(uintptr_t));
   // The appropriate `Simulator::SimulateRuntimeCall()` wrapper and the function
-  // to call are passed inlined in the assembly.
-  uintptr_t call_wrapper_address =
-      MemRead<uintptr_t>(instr + kRuntimeCallWrapperOffset);
-  uintptr_t function_address =
-      MemRead<uintptr_t>(instr + kRuntimeCallFunctionOffset);
-  RuntimeCallType call_type = static_cast<RuntimeCallType>(
-      MemRead<uint32_t>(instr + kRuntimeCallTypeOffset));
-  auto runtime_call_wrapper =
+  // to call are passed inlined in the assembly. Like the instructions, they
+  // are read directly from host memory.
+  uintptr_t call_wrapper_address;
+  uintptr_t function_address;
+  uint32_t call_type_value;
+  memcpy(&call_wrapper_address,
+         instr + kRuntimeCallWrapperOffset,
+         sizeof(call_wrapper_address));
+  memcpy(&function_address,
+         instr + kRuntimeCallFunctionOffset,
+         sizeof(function_address));
+  memcpy(&call_type_value,
+         instr + kRuntimeCallTypeOffset,
+         sizeof(call_type_value));
+
+  // The resolved call site, including its entry in runtime_call_stats_, is
+  // cached by pc. Code addresses can be reused (for example by a CodeSpace),
+  // so the inline words are checked on every hit.
+  uintptr_t pc = reinterpret_cast<uintptr_t>(instr);
+  RuntimeCallSite* site =
+      &runtime_call_cache_[(pc / kInstructionSize) % kRuntimeCallCacheSize];
+  if ((site->pc != instr) || (site->wrapper_address != call_wrapper_address) ||
+      (site->function != function_address) ||
+      (site->type_value != call_type_value)) {
+    site->pc = instr;
+    site->wrapper_address = call_wrapper_address;
+    site->function = function_address;
+    site->type_value = call_type_value;
+    // This value-initialises the counters for new functions.
+    site->stats = &runtime_call_stats_[function_address];
+  }
+
+  void (*wrapper)(Simulator*, uintptr_t) =
       reinterpret_cast<void (*)(Simulator*, uintptr_t)>(call_wrapper_address);
+  RuntimeCallType call_type = static_cast<RuntimeCallType>(call_type_value);
 
   if (call_type == kCallRuntime) {
     WriteRegister(kLinkRegCode,
                   instr->GetInstructionAtOffset(kRuntimeCallLength));
   }
-  runtime_call_wrapper(this, function_address);
+  SimRuntimeCallStats* stats = site->stats;
+  stats->calls++;
+  if (runtime_call_timing_) {
+    auto start = std::chrono::steady_clock::now();
+    wrapper(this, function_address);
+    auto end = std::chrono::steady_clock::now();
+    stats->host_time_ns +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count();
+  } else {
+    wrapper(this, function_address);
+  }
   // Read the return address from `lr` and write it into `pc`.
   WritePc(ReadRegister<Instruction*>(kLinkRegCode));
 }
@@ -11940,10 +12553,12 @@ void Simulator::DoConfigureCPUFeatures(const Instruction* instr) {
   size_t element_size = sizeof(ElementType);
   size_t offset = kConfigureCPUFeaturesListOffset;
 
-  // Read the kNone-terminated list of features.
+  // Read the kNone-terminated list of features. Like the instructions, this is
+  // read directly from host memory.
   CPUFeatures parameters;
   while (true) {
-    ElementType feature = MemRead<ElementType>(instr + offset);
+    ElementType feature;
+    memcpy(&feature, instr + offset, sizeof(feature));
     offset += element_size;
     if (feature == static_cast<ElementType>(CPUFeatures::kNone)) break;
     parameters.Combine(static_cast<CPUFeatures::Feature>(feature));
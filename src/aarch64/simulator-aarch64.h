@@ -27,7 +27,10 @@
 #ifndef VIXL_AARCH64_SIMULATOR_AARCH64_H_
 #define VIXL_AARCH64_SIMULATOR_AARCH64_H_
 
+#include <array>
+#include <map>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "../globals-vixl.h"
@@ -38,6 +41,7 @@
 #include "cpu-features-auditor-aarch64.h"
 #include "disasm-aarch64.h"
 #include "instructions-aarch64.h"
+#include "memory-trace-aarch64.h"
 #include "simulator-constants-aarch64.h"
 
 #ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
@@ -152,13 +156,335 @@ class SimStack {
   static const size_t kDefaultUsableSize = 8 * 1024;
 };
 
+// Copy-on-write tracking of simulated writes to a set of host memory ranges.
+//
+// When tracking is enabled, the first write to each page of a tracked range
+// saves the original contents of that page. RestoreDirtyPages() then puts
+// them back, so the cost of a restore is proportional to the number of pages
+// written, rather than to the size of the tracked ranges.
+//
+// Only writes made by simulated instructions are tracked; writes made by the
+// host (for example, in simulated runtime calls) are not.
+class SimDirtyPageTracker {
+ public:
+  SimDirtyPageTracker()
+      : enabled_(false), dirty_page_count_(0), last_saved_page_(kNoPage) {}
+
+  // Add a range to be tracked. Ranges must not overlap.
+  void AddRange(uintptr_t base, size_t size);
+
+  // Start tracking writes, discarding any pages saved so far.
+  void Enable() {
+    DiscardDirtyPages();
+    enabled_ = true;
+  }
+
+  void Disable() {
+    DiscardDirtyPages();
+    enabled_ = false;
+  }
+
+  bool IsEnabled() const { return enabled_; }
+
+  // This must be called before every simulated write.
+  void NotifyWrite(uintptr_t address, size_t size) {
+    if (!enabled_) return;
+    // Fast path: repeated writes to the most recently saved page.
+    uintptr_t page = address >> kPageSizeLog2;
+    uintptr_t last_page = (address + size - 1) >> kPageSizeLog2;
+    if ((page == last_saved_page_) && (last_page == page)) return;
+    for (; page <= last_page; page++) SavePage(page);
+  }
+
+  // Restore the original contents of every page written since tracking was
+  // enabled (or since the last restore), and carry on tracking.
+  void RestoreDirtyPages();
+
+  size_t GetDirtyPageCount() const { return dirty_page_count_; }
+
+ private:
+  void SavePage(uintptr_t page);
+
+  void DiscardDirtyPages() {
+    saved_pages_.clear();
+    dirty_page_count_ = 0;
+    last_saved_page_ = kNoPage;
+  }
+
+  struct Range {
+    uintptr_t base;
+    size_t size;
+  };
+
+  struct SavedChunk {
+    uintptr_t address;
+    std::vector<uint8_t> data;
+  };
+
+  static const uintptr_t kNoPage = ~static_cast<uintptr_t>(0);
+
+  bool enabled_;
+  std::vector<Range> ranges_;
+
+  // The saved parts of each written page, indexed by page number. Usually,
+  // this holds a single chunk, but a page can be shared by several ranges.
+  // Written pages outside every range are recorded with no chunks.
+  std::unordered_map<uintptr_t, std::vector<SavedChunk>> saved_pages_;
+  size_t dirty_page_count_;
+  uintptr_t last_saved_page_;
+};
+
+// An optional, sandboxed address space for simulated loads and stores.
+//
+// By default, the Simulator treats simulated addresses as host pointers. When
+// a SimGuestMemory is installed (with Simulator::SetGuestMemory()), loads and
+// stores can only reach the guest regions that have been mapped, with the
+// permissions given to each region, and any other access aborts the
+// simulation. Instruction fetches (including the data embedded in simulator
+// pseudo-instructions) are not affected, so generated code still runs from
+// host memory. However, literal loads are data accesses, so code that uses
+// literal pools needs its code buffer to be mapped for reading.
+//
+// Guest regions are backed by host memory. They can be mapped onto existing
+// host memory (possibly at the same address, so that host pointers can be
+// passed to simulated code unchanged), or allocated by the SimGuestMemory.
+// Translations are cached, a page at a time, in a small direct-mapped TLB.
+//
+// TakeSnapshot() makes every region copy-on-write: the first write to each
+// page copies it, and later accesses to the page use the copy. The original
+// host memory is left untouched until DiscardSnapshot() writes the copies
+// back, so RestoreSnapshot() only has to drop the copies. Whilst a snapshot is
+// active, the host should use Read() and Write() to see the guest's view of
+// memory.
+class SimGuestMemory {
+ public:
+  enum Permissions { kNoAccess = 0, kRead = 1, kWrite = 2, kReadWrite = 3 };
+
+  SimGuestMemory() : snapshot_active_(false) { FlushTLB(); }
+
+  // Map [guest_address, guest_address + size) onto host memory at `host`,
+  // which must outlive the mapping. Regions must not overlap. There are no
+  // alignment requirements, but accesses to pages that are not entirely
+  // covered by one region are not cached in the TLB.
+  void MapRegion(uint64_t guest_address,
+                 void* host,
+                 size_t size,
+                 int permissions);
+
+  // Like MapRegion(), but backed by zero-initialised host memory owned by the
+  // SimGuestMemory. The host memory is returned.
+  void* AllocateRegion(uint64_t guest_address, size_t size, int permissions);
+
+  // Unmap the region starting at `guest_address`. Copies made since the last
+  // snapshot are discarded.
+  void UnmapRegion(uint64_t guest_address);
+
+  // Change the permissions of the region starting at `guest_address`.
+  void SetRegionPermissions(uint64_t guest_address, int permissions);
+
+  // Return the host address of [address, address + size), or NULL if the
+  // access is not permitted, or if it crosses a page boundary. `access` must
+  // be kRead or kWrite.
+  char* Translate(uint64_t address, size_t size, int access) {
+    uint64_t offset = address & (kPageSize - 1);
+    if ((offset + size) <= kPageSize) {
+      const TLBEntry& entry = tlb_[(address >> kPageSizeLog2) & kTLBMask];
+      uint64_t tag = (access == kWrite) ? entry.write_tag : entry.read_tag;
+      if (tag == (address - offset)) return entry.host + offset;
+    }
+    return TranslateSlow(address, size, access);
+  }
+
+  // Copy between guest and host memory, splitting the access at page
+  // boundaries. If `tracker` is not NULL, it is notified of each host write.
+  // Return false (having copied only a prefix) if any part of the access is
+  // not permitted.
+  bool Read(uint64_t address, void* dst, size_t size);
+  bool Write(uint64_t address,
+             const void* src,
+             size_t size,
+             SimDirtyPageTracker* tracker = NULL);
+
+  // Return true if every byte of [address, address + size) can be accessed.
+  bool IsAccessible(uint64_t address, size_t size, int access);
+
+  // Take a copy-on-write snapshot of all regions, replacing (and committing)
+  // any existing snapshot.
+  void TakeSnapshot();
+  // Return the guest memory to the state it had when the snapshot was taken,
+  // leaving the snapshot active.
+  void RestoreSnapshot();
+  // Commit every write made since the snapshot to the host memory, and stop
+  // making copies.
+  void DiscardSnapshot();
+
+  bool IsSnapshotActive() const { return snapshot_active_; }
+  size_t GetCopiedPageCount() const { return copied_pages_.size(); }
+
+ private:
+  struct Region {
+    uint64_t start;
+    uint64_t size;
+    char* host;
+    int permissions;
+    std::unique_ptr<char[]> owned;
+  };
+
+  // A cached translation. Each tag is the guest address of a page that can be
+  // accessed in the corresponding way, or kInvalidTag. The host pointer is the
+  // host address of the start of the page.
+  struct TLBEntry {
+    uint64_t read_tag;
+    uint64_t write_tag;
+    char* host;
+  };
+
+  static const int kTLBSizeLog2 = 8;
+  static const uint64_t kTLBMask = (UINT64_C(1) << kTLBSizeLog2) - 1;
+  // No page starts at an odd address.
+  static const uint64_t kInvalidTag = 1;
+
+  char* TranslateSlow(uint64_t address, size_t size, int access);
+  Region* FindRegion(uint64_t address);
+  char* CopyPage(uint64_t page);
+  // Copy the parts of `page` that are covered by regions from (or to) the
+  // host memory backing those regions.
+  void CopyCoveredBytes(uint64_t page, char* copy, bool to_host);
+  void FlushTLB();
+
+  TLBEntry tlb_[1 << kTLBSizeLog2];
+
+  // Regions, indexed by their guest start address.
+  std::map<uint64_t, Region> regions_;
+
+  bool snapshot_active_;
+  // Pages written since the snapshot was taken, indexed by guest address.
+  std::unordered_map<uint64_t, std::unique_ptr<char[]>> copied_pages_;
+};
+
+// A compact record of a simulated access that hit a watchpoint.
+struct SimWatchpointHit {
+  uint64_t pc;
+  uint64_t address;
+  // The data that was accessed, or its first eight bytes for larger accesses.
+  uint64_t value;
+  uint32_t size;
+  // SimWatchpoints::kRead or SimWatchpoints::kWrite.
+  uint32_t access;
+};
+
+// Address ranges to watch for simulated loads and stores.
+//
+// Every simulated access first tests one bit per page that it touches, in a
+// filter indexed by page number, so accesses to unwatched pages are cheap.
+// Bits are shared between pages, so a set bit only means that the access
+// might hit a watchpoint; the ranges themselves are then checked.
+//
+// Hits are recorded in a fixed-size log, which keeps the most recent hits
+// when it overflows. A watchpoint can also ask the Simulator to stop, once
+// the instruction that hit it has completed.
+class SimWatchpoints {
+ public:
+  enum Access { kRead = 1, kWrite = 2, kReadWrite = 3 };
+
+  static const size_t kDefaultLogCapacity = 1024;
+
+  explicit SimWatchpoints(size_t log_capacity = kDefaultLogCapacity)
+      : log_capacity_(log_capacity), hit_count_(0), stop_requested_(false) {
+    VIXL_ASSERT(log_capacity > 0);
+    memset(filter_, 0, sizeof(filter_));
+  }
+
+  // Watch [address, address + size) for the accesses in `access`. If `stop`
+  // is true, every hit also stops the simulation.
+  void Add(uint64_t address, size_t size, int access, bool stop = false);
+  // Remove every watchpoint that starts at `address`.
+  void Remove(uint64_t address);
+  void Clear();
+
+  // Return false if [address, address + size) cannot hit any watchpoint.
+  bool MightHit(uint64_t address, size_t size) const {
+    uint64_t page = address >> kPageSizeLog2;
+    uint64_t last_page = (address + size - 1) >> kPageSizeLog2;
+    for (; page <= last_page; page++) {
+      uint64_t bit = page & kFilterMask;
+      if ((filter_[bit / 64] & (UINT64_C(1) << (bit % 64))) != 0) return true;
+    }
+    return false;
+  }
+
+  // Log the access if it hits a watchpoint.
+  void Check(uint64_t pc,
+             uint64_t address,
+             const void* data,
+             size_t size,
+             int access);
+
+  // Return true (once) if a watchpoint has asked the Simulator to stop.
+  bool ConsumeStopRequest() {
+    bool stop = stop_requested_;
+    stop_requested_ = false;
+    return stop;
+  }
+
+  // The total number of hits, including any that no longer fit in the log.
+  uint64_t GetHitCount() const { return hit_count_; }
+  // The number of hits in the log, and each of them, oldest first.
+  size_t GetLoggedHitCount() const { return log_.size(); }
+  const SimWatchpointHit& GetLoggedHit(size_t index) const {
+    VIXL_ASSERT(index < log_.size());
+    if (log_.size() < log_capacity_) return log_[index];
+    return log_[(hit_count_ + index) % log_capacity_];
+  }
+  void ClearLog() {
+    log_.clear();
+    hit_count_ = 0;
+  }
+
+ private:
+  struct Range {
+    uint64_t address;
+    uint64_t size;
+    int access;
+    bool stop;
+  };
+
+  void AddToFilter(const Range& range);
+
+  static const int kFilterSizeLog2 = 16;
+  static const uint64_t kFilterMask = (UINT64_C(1) << kFilterSizeLog2) - 1;
+  uint64_t filter_[(1 << kFilterSizeLog2) / 64];
+
+  std::vector<Range> ranges_;
+
+  std::vector<SimWatchpointHit> log_;
+  size_t log_capacity_;
+  uint64_t hit_count_;
+  bool stop_requested_;
+};
+
 // Representation of memory, with typed getters and setters for access.
 class Memory {
  public:
-  explicit Memory(SimStack::Allocated stack) : stack_(std::move(stack)) {}
+  explicit Memory(SimStack::Allocated stack)
+      : stack_(std::move(stack)),
+        dirty_page_tracker_(NULL),
+        guest_memory_(NULL) {}
 
   const SimStack::Allocated& GetStack() { return stack_; }
 
+  // Notify `tracker` of every write. This can be NULL.
+  void SetDirtyPageTracker(SimDirtyPageTracker* tracker) {
+    dirty_page_tracker_ = tracker;
+  }
+
+  // Translate every access through `guest_memory`. If this is NULL, simulated
+  // addresses are host addresses.
+  void SetGuestMemory(SimGuestMemory* guest_memory) {
+    guest_memory_ = guest_memory;
+  }
+  SimGuestMemory* GetGuestMemory() const { return guest_memory_; }
+
   template <typename T>
   T AddressUntag(T address) const {
     // Cast the address using a C-style cast. A reinterpret_cast would be
@@ -178,7 +504,11 @@ class Memory {
     if (stack_.IsAccessInGuardRegion(base, sizeof(value))) {
       VIXL_ABORT_WITH_MSG("Attempt to read from stack guard region");
     }
-    memcpy(&value, base, sizeof(value));
+    if (guest_memory_ != NULL) {
+      ReadGuest((uint64_t)address, &value, sizeof(value));
+    } else {
+      memcpy(&value, base, sizeof(value));
+    }
     return value;
   }
 
@@ -192,9 +522,57 @@ class Memory {
     if (stack_.IsAccessInGuardRegion(base, sizeof(value))) {
       VIXL_ABORT_WITH_MSG("Attempt to write to stack guard region");
     }
+    if (guest_memory_ != NULL) {
+      WriteGuest((uint64_t)address, &value, sizeof(value));
+      return;
+    }
+    if (dirty_page_tracker_ != NULL) {
+      dirty_page_tracker_->NotifyWrite(reinterpret_cast<uintptr_t>(base),
+                                       sizeof(value));
+    }
     memcpy(base, &value, sizeof(value));
   }
 
+  // Copy blocks of memory, such as whole vectors. The guard regions are
+  // checked once for the whole block.
+  template <typename A>
+  void ReadBlock(A address, void* dst, size_t size) const {
+    address = AddressUntag(address);
+    auto base = reinterpret_cast<const char*>(address);
+    if (stack_.IsAccessInGuardRegion(base, size)) {
+      VIXL_ABORT_WITH_MSG("Attempt to read from stack guard region");
+    }
+    if (guest_memory_ != NULL) {
+      ReadGuest((uint64_t)address, dst, size);
+    } else {
+      memcpy(dst, base, size);
+    }
+  }
+
+  template <typename A>
+  void WriteBlock(A address, const void* src, size_t size) const {
+    address = AddressUntag(address);
+    auto base = reinterpret_cast<char*>(address);
+    if (stack_.IsAccessInGuardRegion(base, size)) {
+      VIXL_ABORT_WITH_MSG("Attempt to write to stack guard region");
+    }
+    if (guest_memory_ != NULL) {
+      WriteGuest((uint64_t)address, src, size);
+      return;
+    }
+    if (dirty_page_tracker_ != NULL) {
+      dirty_page_tracker_->NotifyWrite(reinterpret_cast<uintptr_t>(base), size);
+    }
+    memcpy(base, src, size);
+  }
+
+  template <typename A>
+  bool IsAccessInGuardRegion(A address, size_t size) const {
+    address = AddressUntag(address);
+    return stack_.IsAccessInGuardRegion(reinterpret_cast<const char*>(address),
+                                        size);
+  }
+
   template <typename A>
   uint64_t ReadUint(int size_in_bytes, A address) const {
     switch (size_in_bytes) {
@@ -243,7 +621,33 @@ class Memory {
   }
 
  private:
+  void ReadGuest(uint64_t address, void* dst, size_t size) const {
+    const char* host =
+        guest_memory_->Translate(address, size, SimGuestMemory::kRead);
+    if (host != NULL) {
+      memcpy(dst, host, size);
+    } else if (!guest_memory_->Read(address, dst, size)) {
+      VIXL_ABORT_WITH_MSG("Attempt to read from inaccessible guest memory");
+    }
+  }
+
+  void WriteGuest(uint64_t address, const void* src, size_t size) const {
+    char* host =
+        guest_memory_->Translate(address, size, SimGuestMemory::kWrite);
+    if (host != NULL) {
+      if (dirty_page_tracker_ != NULL) {
+        dirty_page_tracker_->NotifyWrite(reinterpret_cast<uintptr_t>(host),
+                                         size);
+      }
+      memcpy(host, src, size);
+    } else if (!guest_memory_->Write(address, src, size, dirty_page_tracker_)) {
+      VIXL_ABORT_WITH_MSG("Attempt to write to inaccessible guest memory");
+    }
+  }
+
   SimStack::Allocated stack_;
+  SimDirtyPageTracker* dirty_page_tracker_;
+  SimGuestMemory* guest_memory_;
 };
 
 // Represent a register (r0-r31, v0-v31, z0-z31, p0-p15).
@@ -253,7 +657,32 @@ class SimRegisterBase {
   static const unsigned kMaxSizeInBytes = kMaxSizeInBits / kBitsPerByte;
   VIXL_STATIC_ASSERT((kMaxSizeInBytes * kBitsPerByte) == kMaxSizeInBits);
 
-  SimRegisterBase() : size_in_bytes_(kMaxSizeInBytes) { Clear(); }
+  SimRegisterBase()
+      : size_in_bytes_(kMaxSizeInBytes),
+        reset_generation_(NULL),
+        generation_(0),
+        reset_lane_size_in_bytes_(0),
+        reset_value_(0),
+        reset_step_(0),
+        reset_since_last_log_(false) {
+    Clear();
+  }
+
+  // Copies take the value of the source register (applying any pending reset
+  // first), but they never inherit its lazy reset configuration.
+  SimRegisterBase(const SimRegisterBase& other)
+      : reset_generation_(NULL),
+        generation_(0),
+        reset_lane_size_in_bytes_(0),
+        reset_value_(0),
+        reset_step_(0) {
+    CopyFrom(other);
+  }
+
+  SimRegisterBase& operator=(const SimRegisterBase& other) {
+    CopyFrom(other);
+    return *this;
+  }
 
   unsigned GetSizeInBits() const { return size_in_bytes_ * kBitsPerByte; }
   unsigned GetSizeInBytes() const { return size_in_bytes_; }
@@ -282,10 +711,38 @@ class SimRegisterBase {
   }
 
   void Clear() {
-    memset(value_, 0, kMaxSizeInBytes);
+    // This overwrites the whole register, so any pending reset can be
+    // discarded.
+    MarkResetApplied();
+    memset(value_, 0, size_in_bytes_);
     NotifyRegisterWrite();
   }
 
+  // Configure the register to be reset lazily: whenever `*generation` is
+  // incremented, the register is reset, but its value is only generated when
+  // it is next accessed. This makes resets independent of the register size.
+  //
+  // A reset sets each `lane_size_in_bytes`-sized lane, `n`, to
+  // `value + (n * step)`.
+  void SetLazyReset(const uint64_t* generation,
+                    unsigned lane_size_in_bytes,
+                    uint64_t value,
+                    uint64_t step) {
+    VIXL_STATIC_ASSERT(kSupportsLazyReset);
+    VIXL_ASSERT((lane_size_in_bytes == kHRegSizeInBytes) ||
+                (lane_size_in_bytes == kDRegSizeInBytes));
+    reset_generation_ = generation;
+    generation_ = *generation;
+    reset_lane_size_in_bytes_ = lane_size_in_bytes;
+    reset_value_ = value;
+    reset_step_ = step;
+  }
+
+  bool IsResetPending() const {
+    return kSupportsLazyReset && (reset_generation_ != NULL) &&
+           (generation_ != *reset_generation_);
+  }
+
   // Insert a typed value into a register, leaving the rest of the register
   // unchanged. The lane parameter indicates where in the register the value
   // should be inserted, in the range [ 0, sizeof(value_) / sizeof(T) ), where
@@ -315,25 +772,65 @@ class SimRegisterBase {
     return GetLane(lane);
   }
 
+  // Copy `lane_count` lanes, starting from lane 0, to or from an array. This
+  // is much faster than accessing each lane individually.
+  template <typename T>
+  void ReadLanes(T* dst, int lane_count) const {
+    ApplyPendingReset();
+    VIXL_ASSERT((lane_count * sizeof(*dst)) <= GetSizeInBytes());
+    memcpy(dst, value_, lane_count * sizeof(*dst));
+  }
+
+  template <typename T>
+  void WriteLanes(const T* src, int lane_count) {
+    size_t size = lane_count * sizeof(*src);
+    VIXL_ASSERT(size <= GetSizeInBytes());
+    if (size == GetSizeInBytes()) {
+      MarkResetApplied();
+    } else {
+      ApplyPendingReset();
+    }
+    memcpy(value_, src, size);
+    NotifyRegisterWrite();
+  }
+
   // Get the value of a specific bit, indexed from the least-significant bit of
   // lane 0.
   bool GetBit(int bit) const {
+    ApplyPendingReset();
     int bit_in_byte = bit % (sizeof(value_[0]) * kBitsPerByte);
     int byte = bit / (sizeof(value_[0]) * kBitsPerByte);
     return ((value_[byte] >> bit_in_byte) & 1) != 0;
   }
 
   // Return a pointer to the raw, underlying byte array.
-  const uint8_t* GetBytes() const { return value_; }
+  const uint8_t* GetBytes() const {
+    ApplyPendingReset();
+    return value_;
+  }
 
   // TODO: Make this return a map of updated bytes, so that we can highlight
   // updated lanes for load-and-insert. (That never happens for scalar code, but
   // NEON has some instructions that can update individual lanes.)
-  bool WrittenSinceLastLog() const { return written_since_last_log_; }
+  bool WrittenSinceLastLog() const {
+    return written_since_last_log_ || IsResetPending();
+  }
 
-  void NotifyRegisterLogged() { written_since_last_log_ = false; }
+  // Return true if the register has been reset since it was last logged.
+  bool ResetSinceLastLog() const {
+    return reset_since_last_log_ || IsResetPending();
+  }
+
+  void NotifyRegisterLogged() {
+    written_since_last_log_ = false;
+    reset_since_last_log_ = false;
+  }
 
  protected:
+  // Only registers larger than X registers are reset lazily, so that the
+  // checks compile away for the most common accesses.
+  static const bool kSupportsLazyReset = kMaxSizeInBits > kXRegSize;
+
   uint8_t value_[kMaxSizeInBytes];
 
   unsigned size_in_bytes_;
@@ -344,8 +841,58 @@ class SimRegisterBase {
   void NotifyRegisterWrite() { written_since_last_log_ = true; }
 
  private:
+  // Lazy reset state. The register is up to date when `generation_` matches
+  // `*reset_generation_`.
+  const uint64_t* reset_generation_;
+  uint64_t generation_;
+  unsigned reset_lane_size_in_bytes_;
+  uint64_t reset_value_;
+  uint64_t reset_step_;
+  bool reset_since_last_log_;
+
+  void MarkResetApplied() {
+    if (reset_generation_ != NULL) generation_ = *reset_generation_;
+  }
+
+  // Lazily-reset values are conceptually already present, so this is a const
+  // operation even though it has to write to the underlying storage.
+  void ApplyPendingReset() const {
+    if (IsResetPending()) const_cast<SimRegisterBase*>(this)->ApplyReset();
+  }
+
+  void ApplyReset() {
+    unsigned lane_count = size_in_bytes_ / reset_lane_size_in_bytes_;
+    VIXL_ASSERT((lane_count * reset_lane_size_in_bytes_) == size_in_bytes_);
+    for (unsigned lane = 0; lane < lane_count; lane++) {
+      uint64_t value = reset_value_ + (lane * reset_step_);
+      if (reset_lane_size_in_bytes_ == kDRegSizeInBytes) {
+        WriteLaneRaw(value, lane);
+      } else {
+        WriteLaneRaw(static_cast<uint16_t>(value), lane);
+      }
+    }
+    MarkResetApplied();
+    written_since_last_log_ = true;
+    reset_since_last_log_ = true;
+  }
+
+  void CopyFrom(const SimRegisterBase& other) {
+    other.ApplyPendingReset();
+    size_in_bytes_ = other.size_in_bytes_;
+    memcpy(value_, other.value_, size_in_bytes_);
+    written_since_last_log_ = other.written_since_last_log_;
+    reset_since_last_log_ = other.reset_since_last_log_;
+    MarkResetApplied();
+  }
+
+  template <typename T>
+  void WriteLaneRaw(T src, int lane) {
+    memcpy(&value_[lane * sizeof(src)], &src, sizeof(src));
+  }
+
   template <typename T>
   void ReadLane(T* dst, int lane) const {
+    ApplyPendingReset();
     VIXL_ASSERT(lane >= 0);
     VIXL_ASSERT((sizeof(*dst) + (lane * sizeof(*dst))) <= GetSizeInBytes());
     memcpy(dst, &value_[lane * sizeof(*dst)], sizeof(*dst));
@@ -353,6 +900,7 @@ class SimRegisterBase {
 
   template <typename T>
   void WriteLane(T src, int lane) {
+    ApplyPendingReset();
     VIXL_ASSERT(lane >= 0);
     VIXL_ASSERT((sizeof(src) + (lane * sizeof(src))) <= GetSizeInBytes());
     memcpy(&value_[lane * sizeof(src)], &src, sizeof(src));
@@ -390,7 +938,10 @@ class SimVRegister : public SimRegisterBase<kZRegMaxSize> {
     accessed_as_z_ = false;
   }
 
-  bool AccessedAsZSinceLastLog() const { return accessed_as_z_; }
+  // Resets initialise the whole Z register, so they count as Z accesses.
+  bool AccessedAsZSinceLastLog() const {
+    return accessed_as_z_ || ResetSinceLastLog();
+  }
 
  private:
   bool accessed_as_z_;
@@ -454,6 +1005,58 @@ class LogicPRegister {
     return register_.GetLane<T>(lane);
   }
 
+  // Word-wise accessors, to process up to 64 predicate bits at once. The last
+  // word may be partial; bits beyond the end of the register read as zero, and
+  // are ignored on write.
+  int GetWordCount() const {
+    return (register_.GetSizeInBits() + kXRegSize - 1) / kXRegSize;
+  }
+
+  uint64_t GetWord(int index) const {
+    VIXL_ASSERT((index >= 0) && (index < GetWordCount()));
+    unsigned offset = index * kXRegSizeInBytes;
+    unsigned size =
+        std::min(register_.GetSizeInBytes() - offset, kXRegSizeInBytes);
+    uint64_t word = 0;
+    memcpy(&word, register_.GetBytes() + offset, size);
+    return word;
+  }
+
+  void SetWord(int index, uint64_t value) {
+    VIXL_ASSERT((index >= 0) && (index < GetWordCount()));
+    unsigned offset = index * kXRegSizeInBytes;
+    if ((register_.GetSizeInBytes() - offset) >= kXRegSizeInBytes) {
+      register_.Insert<uint64_t>(index, value);
+    } else {
+      // The register size is always a multiple of the chunk size.
+      int chunk_bits = sizeof(ChunkType) * kBitsPerByte;
+      for (unsigned i = 0; (offset + (i * sizeof(ChunkType))) <
+                           register_.GetSizeInBytes();
+           i++) {
+        SetChunk((offset / sizeof(ChunkType)) + i,
+                 static_cast<ChunkType>(value >> (i * chunk_bits)));
+      }
+    }
+  }
+
+  // Return a mask with the bit that governs each lane set. Only these bits are
+  // significant when predicating lanes of the specified format.
+  static uint64_t GetLaneMask(VectorFormat vform) {
+    switch (LaneSizeInBytesFromFormat(vform)) {
+      case kBRegSizeInBytes:
+        return UINT64_C(0xffffffffffffffff);
+      case kHRegSizeInBytes:
+        return UINT64_C(0x5555555555555555);
+      case kSRegSizeInBytes:
+        return UINT64_C(0x1111111111111111);
+      case kDRegSizeInBytes:
+        return UINT64_C(0x0101010101010101);
+      default:
+        VIXL_UNREACHABLE();
+        return 0;
+    }
+  }
+
   template <typename T>
   void SetActiveMask(int lane, T new_value) {
     register_.Insert<T>(lane, new_value);
@@ -622,6 +1225,34 @@ class LogicVRegister {
     }
   }
 
+  // Bulk accessors for whole SVE registers, as arrays of lanes.
+  template <typename T>
+  void ReadLanes(T* dst, int lane_count) const {
+    register_.NotifyAccessAsZ();
+    register_.ReadLanes(dst, lane_count);
+  }
+
+  template <typename T>
+  void WriteLanes(const T* src, int lane_count) const {
+    register_.NotifyAccessAsZ();
+    register_.WriteLanes(src, lane_count);
+  }
+
+  // Bulk accessors for any register format. Like the other accessors, these
+  // only affect the low-order `lane_count` elements, so NEON destinations
+  // should use ClearForWrite() first.
+  template <typename T>
+  void ReadLanes(VectorFormat vform, T* dst, int lane_count) const {
+    if (IsSVEFormat(vform)) register_.NotifyAccessAsZ();
+    register_.ReadLanes(dst, lane_count);
+  }
+
+  template <typename T>
+  void WriteLanes(VectorFormat vform, const T* src, int lane_count) const {
+    if (IsSVEFormat(vform)) register_.NotifyAccessAsZ();
+    register_.WriteLanes(src, lane_count);
+  }
+
   template <typename T>
   T Float(int index) const {
     return register_.GetLane<T>(index);
@@ -1017,6 +1648,59 @@ class SimExclusiveGlobalMonitor {
 };
 
 
+// A snapshot of the simulated processor state, used by
+// Simulator::SaveCheckpoint() and Simulator::RestoreCheckpoint().
+struct SimCheckpoint {
+  SimRegister registers[kNumberOfRegisters];
+  // The Z, P and FFR registers are stored at the vector length that was
+  // configured when the checkpoint was taken.
+  unsigned vector_length;
+  std::vector<uint64_t> z_registers;
+  std::vector<uint16_t> p_registers;
+  std::vector<uint16_t> ffr_register;
+  SimSystemRegister nzcv;
+  SimSystemRegister fpcr;
+  const Instruction* pc;
+  BType btype;
+  BType next_btype;
+  uint16_t rand_state[3];
+  uint64_t executed_instruction_count;
+};
+
+// Counters describing the SVE gather loads and scatter stores simulated since
+// the last Simulator::ResetState(). Memory is modelled as a sequence of
+// kLineSize-byte lines, so `unique_lines` approximates the number of distinct
+// cache lines that each access would touch on hardware.
+struct SimGatherScatterStats {
+  static const int kLineSizeLog2 = 6;
+  static const int kLineSize = 1 << kLineSizeLog2;
+
+  uint64_t gathers;
+  uint64_t scatters;
+  // The number of active elements accessed.
+  uint64_t elements;
+  // The sum, over all accesses, of the number of distinct lines touched.
+  uint64_t unique_lines;
+  // The number of accesses whose active elements were contiguous in memory,
+  // or separated by a constant, non-zero stride.
+  uint64_t contiguous;
+  uint64_t strided;
+  // The number of active elements that did not need a separate memory access
+  // because another element in the same instruction used the same address.
+  uint64_t coalesced_elements;
+};
+
+// Counters for the calls made to one host function through
+// MacroAssembler::CallRuntime() or TailCallRuntime(), since the last
+// Simulator::ResetState().
+struct SimRuntimeCallStats {
+  uint64_t calls;
+  // The total time spent in the host function, in nanoseconds. This is only
+  // measured when runtime call timing is enabled; see
+  // Simulator::EnableRuntimeCallTiming().
+  uint64_t host_time_ns;
+};
+
 class Simulator : public DecoderVisitor {
  public:
   explicit Simulator(Decoder* decoder,
@@ -1030,6 +1714,101 @@ class Simulator : public DecoderVisitor {
   virtual void Run();
   void RunFrom(const Instruction* first);
 
+  // Run the simulator from the current pc for a limited number of
+  // instructions. Execution can be resumed with a later call to RunFor() or
+  // Run(), so that a single host thread can interleave several simulated
+  // contexts.
+  //
+  // To keep the overhead negligible, the budget is only checked at the end of
+  // basic blocks (when an instruction explicitly writes the pc). This means
+  // that slightly more than `instruction_budget` instructions may be
+  // executed, but execution always stops on an instruction boundary, where the
+  // simulator state can be saved or inspected.
+  //
+  // Returns true if the simulation has finished (that is, the pc reached
+  // kEndOfSimAddress), and false if the budget was exhausted first.
+  bool RunFor(uint64_t instruction_budget);
+
+  bool IsFinished() const { return pc_ == kEndOfSimAddress; }
+
+  // The number of instructions executed since the last ResetState().
+  uint64_t GetExecutedInstructionCount() const {
+    return executed_instruction_count_;
+  }
+
+  // Statistics about SVE gather and scatter accesses since the last
+  // ResetState().
+  const SimGatherScatterStats& GetGatherScatterStats() const {
+    return gather_scatter_stats_;
+  }
+
+  // Statistics about simulated runtime calls since the last ResetState(),
+  // indexed by the address of the host function.
+  const std::unordered_map<uintptr_t, SimRuntimeCallStats>&
+  GetRuntimeCallStats() const {
+    return runtime_call_stats_;
+  }
+
+  // Measure the host time spent in each runtime call. This is disabled by
+  // default, because it reads the host clock twice for every call.
+  void EnableRuntimeCallTiming(bool enable = true) {
+    runtime_call_timing_ = enable;
+  }
+
+  // Runtime call sites are cached by pc. Each cached entry is checked against
+  // the code on every call, so rewritten call sites are picked up without
+  // this, but it can be used to drop every entry.
+  void InvalidateRuntimeCallCache();
+
+  // Checkpoints.
+  //
+  // SaveCheckpoint() captures the registers, the system registers and the pc,
+  // and starts tracking simulated writes to the stack and to any memory
+  // registered with RegisterCheckpointMemory(). RestoreCheckpoint() returns
+  // the simulator to that state. It only needs to copy the memory pages that
+  // have been written since the checkpoint (or since the last restore), so it
+  // is cheap to run many short experiments from the same starting point.
+  //
+  // Only one checkpoint exists at a time; saving a new checkpoint replaces the
+  // previous one.
+  void RegisterCheckpointMemory(const void* base, size_t size) {
+    dirty_page_tracker_.AddRange(reinterpret_cast<uintptr_t>(base), size);
+  }
+  void SaveCheckpoint();
+  void RestoreCheckpoint();
+  void DiscardCheckpoint();
+  bool HasCheckpoint() const { return checkpoint_ != NULL; }
+
+  // The number of memory pages that RestoreCheckpoint() would copy.
+  size_t GetCheckpointDirtyPageCount() const {
+    return dirty_page_tracker_.GetDirtyPageCount();
+  }
+
+  // Watchpoints.
+  //
+  // GetWatchpoints() enables watchpoints, if necessary, and returns them so
+  // that ranges can be added and hits inspected. Until then, simulated
+  // accesses only pay for a NULL check. Run() and RunFor() return early if a
+  // watchpoint stops the simulation, and IsStoppedAtWatchpoint() then returns
+  // true until execution is resumed.
+  SimWatchpoints* GetWatchpoints() {
+    if (watchpoints_ == NULL) watchpoints_.reset(new SimWatchpoints());
+    return watchpoints_.get();
+  }
+  void DisableWatchpoints() { watchpoints_.reset(); }
+  bool IsStoppedAtWatchpoint() const { return stopped_at_watchpoint_; }
+
+  // Record every simulated data access in `trace`, or stop recording if
+  // `trace` is NULL. The Simulator does not take ownership of the writer, and
+  // does not flush it.
+  void SetMemoryTrace(MemoryTraceWriter* trace) { memory_trace_ = trace; }
+
+  // Restrict simulated loads and stores to the regions mapped in
+  // `guest_memory`, or pass NULL to access host memory directly. The usable
+  // part of the simulated stack is mapped into `guest_memory` at its host
+  // address, unless something is already mapped there.
+  void SetGuestMemory(SimGuestMemory* guest_memory);
+
 
 #if defined(VIXL_HAS_ABI_SUPPORT) && __cplusplus >= 201103L && \
     (defined(__clang__) || GCC_VERSION_OR_NEWER(4, 9, 1))
@@ -1705,29 +2484,88 @@ class Simulator : public DecoderVisitor {
     }
   }
 
+  // `flags` is a combination of MemoryTraceRecord::Flags, describing the kind
+  // of access for the memory trace. MemoryTraceRecord::kWrite is implied for
+  // writes.
   template <typename T, typename A>
   T MemRead(A address) const {
-    return memory_.Read<T>(address);
+    T value = memory_.Read<T>(address);
+    NotifyMemoryAccess(address, &value, sizeof(value), 0);
+    return value;
   }
 
   template <typename T, typename A>
   void MemWrite(A address, T value) const {
-    return memory_.Write(address, value);
+    memory_.Write(address, value);
+    NotifyMemoryAccess(address,
+                       &value,
+                       sizeof(value),
+                       MemoryTraceRecord::kWrite);
+  }
+
+  template <typename A>
+  uint64_t MemReadUint(int size_in_bytes, A address, int flags = 0) const {
+    uint64_t value = memory_.ReadUint(size_in_bytes, address);
+    NotifyMemoryAccess(address, &value, size_in_bytes, flags);
+    return value;
+  }
+
+  template <typename A>
+  int64_t MemReadInt(int size_in_bytes, A address, int flags = 0) const {
+    int64_t value = memory_.ReadInt(size_in_bytes, address);
+    NotifyMemoryAccess(address, &value, size_in_bytes, flags);
+    return value;
+  }
+
+  template <typename A>
+  void MemWrite(int size_in_bytes,
+                A address,
+                uint64_t value,
+                int flags = 0) const {
+    memory_.Write(size_in_bytes, address, value);
+    NotifyMemoryAccess(address,
+                       &value,
+                       size_in_bytes,
+                       flags | MemoryTraceRecord::kWrite);
   }
 
   template <typename A>
-  uint64_t MemReadUint(int size_in_bytes, A address) const {
-    return memory_.ReadUint(size_in_bytes, address);
+  void MemReadBlock(A address, void* dst, size_t size, int flags = 0) const {
+    memory_.ReadBlock(address, dst, size);
+    NotifyMemoryAccess(address, dst, size, flags);
   }
 
   template <typename A>
-  int64_t MemReadInt(int size_in_bytes, A address) const {
-    return memory_.ReadInt(size_in_bytes, address);
+  void MemWriteBlock(A address,
+                     const void* src,
+                     size_t size,
+                     int flags = 0) const {
+    memory_.WriteBlock(address, src, size);
+    NotifyMemoryAccess(address, src, size, flags | MemoryTraceRecord::kWrite);
   }
 
+  // Pass the access to the memory trace and to the watchpoints, if either is
+  // enabled.
   template <typename A>
-  void MemWrite(int size_in_bytes, A address, uint64_t value) const {
-    return memory_.Write(size_in_bytes, address, value);
+  void NotifyMemoryAccess(A address,
+                          const void* data,
+                          size_t size,
+                          int flags) const {
+    if ((memory_trace_ == NULL) && (watchpoints_ == NULL)) return;
+    uint64_t untagged = (uint64_t)memory_.AddressUntag(address);
+    uint64_t pc = reinterpret_cast<uintptr_t>(pc_);
+    if (memory_trace_ != NULL) {
+      memory_trace_->Append(pc,
+                            untagged,
+                            static_cast<uint32_t>(size),
+                            flags);
+    }
+    if ((watchpoints_ != NULL) && watchpoints_->MightHit(untagged, size)) {
+      int access = ((flags & MemoryTraceRecord::kWrite) != 0)
+                       ? SimWatchpoints::kWrite
+                       : SimWatchpoints::kRead;
+      watchpoints_->Check(pc, untagged, data, size, access);
+    }
   }
 
   void LoadLane(LogicVRegister dst,
@@ -1742,24 +2580,27 @@ class Simulator : public DecoderVisitor {
                       VectorFormat vform,
                       unsigned msize_in_bytes,
                       int index,
-                      uint64_t addr) const {
-    dst.SetUint(vform, index, MemReadUint(msize_in_bytes, addr));
+                      uint64_t addr,
+                      int flags = MemoryTraceRecord::kVector) const {
+    dst.SetUint(vform, index, MemReadUint(msize_in_bytes, addr, flags));
   }
 
   void LoadIntToLane(LogicVRegister dst,
                      VectorFormat vform,
                      unsigned msize_in_bytes,
                      int index,
-                     uint64_t addr) const {
-    dst.SetInt(vform, index, MemReadInt(msize_in_bytes, addr));
+                     uint64_t addr,
+                     int flags = MemoryTraceRecord::kVector) const {
+    dst.SetInt(vform, index, MemReadInt(msize_in_bytes, addr, flags));
   }
 
   void StoreLane(const LogicVRegister& src,
                  VectorFormat vform,
                  int index,
-                 uint64_t addr) const {
+                 uint64_t addr,
+                 int flags = MemoryTraceRecord::kVector) const {
     unsigned msize_in_bytes = LaneSizeInBytesFromFormat(vform);
-    MemWrite(msize_in_bytes, addr, src.Uint(vform, index));
+    MemWrite(msize_in_bytes, addr, src.Uint(vform, index), flags);
   }
 
   uint64_t ComputeMemOperandAddress(const MemOperand& mem_op) const;
@@ -1795,19 +2636,29 @@ class Simulator : public DecoderVisitor {
     }
   }
 
-  bool ReadN() const { return nzcv_.GetN() != 0; }
+  bool ReadN() const { return ReadNzcv().GetN() != 0; }
   VIXL_DEPRECATED("ReadN", bool N() const) { return ReadN(); }
 
-  bool ReadZ() const { return nzcv_.GetZ() != 0; }
+  bool ReadZ() const { return ReadNzcv().GetZ() != 0; }
   VIXL_DEPRECATED("ReadZ", bool Z() const) { return ReadZ(); }
 
-  bool ReadC() const { return nzcv_.GetC() != 0; }
+  bool ReadC() const { return ReadNzcv().GetC() != 0; }
   VIXL_DEPRECATED("ReadC", bool C() const) { return ReadC(); }
 
-  bool ReadV() const { return nzcv_.GetV() != 0; }
+  bool ReadV() const { return ReadNzcv().GetV() != 0; }
   VIXL_DEPRECATED("ReadV", bool V() const) { return ReadV(); }
 
-  SimSystemRegister& ReadNzcv() { return nzcv_; }
+  // The flags set by integer arithmetic and logical instructions are only
+  // computed when they are read, so every access to NZCV must go through
+  // ReadNzcv().
+  SimSystemRegister& ReadNzcv() {
+    if (lazy_nzcv_.source != LazyNzcv::kNone) MaterialiseNzcv();
+    return nzcv_;
+  }
+  const SimSystemRegister& ReadNzcv() const {
+    if (lazy_nzcv_.source != LazyNzcv::kNone) MaterialiseNzcv();
+    return nzcv_;
+  }
   VIXL_DEPRECATED("ReadNzcv", SimSystemRegister& nzcv()) { return ReadNzcv(); }
 
   // TODO: Find a way to make the fpcr_ members return the proper types, so
@@ -2579,33 +3430,50 @@ class Simulator : public DecoderVisitor {
   using __local_index_sequence_for = emulated_index_sequence_for<P...>;
 #endif
 
-  // Expand the argument tuple and perform the call.
+  // The locations of the arguments only depend on the signature, so they are
+  // computed once for each signature, rather than on every call.
+  template <typename... P>
+  static const std::array<GenericOperand, sizeof...(P)>&
+  GetRuntimeCallArgumentOperands() {
+    static const std::array<GenericOperand, sizeof...(P)> operands =
+        ComputeRuntimeCallArgumentOperands<P...>();
+    return operands;
+  }
+
+  template <typename... P>
+  static std::array<GenericOperand, sizeof...(P)>
+  ComputeRuntimeCallArgumentOperands() {
+    ABI abi;
+    // The elements of a braced initialiser list are evaluated in order, so
+    // the ABI allocates the locations in parameter order.
+    std::array<GenericOperand, sizeof...(P)> operands{
+        {abi.GetNextParameterGenericOperand<P>()...}};
+    USE(abi);
+    return operands;
+  }
+
+  // Read the arguments and perform the call.
   template <typename R, typename... P, std::size_t... I>
-  R DoRuntimeCall(R (*function)(P...),
-                  std::tuple<P...> arguments,
-                  local_index_sequence<I...>) {
+  R DoRuntimeCall(R (*function)(P...), local_index_sequence<I...>) {
+    const std::array<GenericOperand, sizeof...(P)>& operands =
+        GetRuntimeCallArgumentOperands<P...>();
+    std::tuple<P...> arguments{ReadGenericOperand<P>(operands[I])...};
+    USE(operands);
     return function(std::get<I>(arguments)...);
   }
 
   template <typename R, typename... P>
   void RuntimeCallNonVoid(R (*function)(P...)) {
-    ABI abi;
-    std::tuple<P...> argument_operands{
-        ReadGenericOperand<P>(abi.GetNextParameterGenericOperand<P>())...};
-    R return_value = DoRuntimeCall(function,
-                                   argument_operands,
-                                   __local_index_sequence_for<P...>{});
-    WriteGenericOperand(abi.GetReturnGenericOperand<R>(), return_value);
+    static const GenericOperand return_operand =
+        ABI().GetReturnGenericOperand<R>();
+    R return_value =
+        DoRuntimeCall(function, __local_index_sequence_for<P...>{});
+    WriteGenericOperand(return_operand, return_value);
   }
 
   template <typename R, typename... P>
   void RuntimeCallVoid(R (*function)(P...)) {
-    ABI abi;
-    std::tuple<P...> argument_operands{
-        ReadGenericOperand<P>(abi.GetNextParameterGenericOperand<P>())...};
-    DoRuntimeCall(function,
-                  argument_operands,
-                  __local_index_sequence_for<P...>{});
+    DoRuntimeCall(function, __local_index_sequence_for<P...>{});
   }
 
   // We use `struct` for `void` return type specialisation.
@@ -2669,12 +3537,30 @@ class Simulator : public DecoderVisitor {
     }
   }
 
+  // Predicates are processed 64 bits at a time. Return the number of words
+  // needed to hold a predicate at the current vector length.
+  int GetPredicateWordCount() const {
+    return (GetPredicateLengthInBytes() + kXRegSizeInBytes - 1) /
+           kXRegSizeInBytes;
+  }
+
+  // Return a mask of the bits in predicate word `index` that govern lanes of
+  // the specified format, within the current vector length.
+  uint64_t GetPredicateLaneMask(VectorFormat vform, int index) const {
+    VIXL_ASSERT((index >= 0) && (index < GetPredicateWordCount()));
+    unsigned bits = GetPredicateLengthInBits() - (index * kXRegSize);
+    uint64_t mask = LogicPRegister::GetLaneMask(vform);
+    return (bits < kXRegSize) ? (mask & GetUintMask(bits)) : mask;
+  }
+
   bool IsFirstActive(VectorFormat vform,
                      const LogicPRegister& mask,
                      const LogicPRegister& bits) {
-    for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-      if (mask.IsActive(vform, i)) {
-        return bits.IsActive(vform, i);
+    for (int i = 0; i < GetPredicateWordCount(); i++) {
+      uint64_t active = mask.GetWord(i) & GetPredicateLaneMask(vform, i);
+      if (active != 0) {
+        // Isolate the lowest set bit.
+        return (bits.GetWord(i) & active & ~(active - 1)) != 0;
       }
     }
     return false;
@@ -2683,8 +3569,9 @@ class Simulator : public DecoderVisitor {
   bool AreNoneActive(VectorFormat vform,
                      const LogicPRegister& mask,
                      const LogicPRegister& bits) {
-    for (int i = 0; i < LaneCountFromFormat(vform); i++) {
-      if (mask.IsActive(vform, i) && bits.IsActive(vform, i)) {
+    for (int i = 0; i < GetPredicateWordCount(); i++) {
+      uint64_t lane_mask = GetPredicateLaneMask(vform, i);
+      if ((mask.GetWord(i) & bits.GetWord(i) & lane_mask) != 0) {
         return false;
       }
     }
@@ -2694,9 +3581,11 @@ class Simulator : public DecoderVisitor {
   bool IsLastActive(VectorFormat vform,
                     const LogicPRegister& mask,
                     const LogicPRegister& bits) {
-    for (int i = LaneCountFromFormat(vform) - 1; i >= 0; i--) {
-      if (mask.IsActive(vform, i)) {
-        return bits.IsActive(vform, i);
+    for (int i = GetPredicateWordCount() - 1; i >= 0; i--) {
+      uint64_t active = mask.GetWord(i) & GetPredicateLaneMask(vform, i);
+      if (active != 0) {
+        int highest = kXRegSize - 1 - CountLeadingZeros(active);
+        return ((bits.GetWord(i) >> highest) & 1) != 0;
       }
     }
     return false;
@@ -2836,6 +3725,18 @@ class Simulator : public DecoderVisitor {
                       unsigned left_shift = 0) const;
   uint16_t PolynomialMult(uint8_t op1, uint8_t op2) const;
 
+  // Load or store `reg_count` whole NEON registers from or to memory holding
+  // interleaved structures, as for LD1-LD4 and ST1-ST4 (multiple structures).
+  // Memory is accessed with a single block copy.
+  void LoadInterleaved(VectorFormat vform,
+                       LogicVRegister* dst,
+                       int reg_count,
+                       uint64_t addr);
+  void StoreInterleaved(VectorFormat vform,
+                        const LogicVRegister* src,
+                        int reg_count,
+                        uint64_t addr);
+
   void ld1(VectorFormat vform, LogicVRegister dst, uint64_t addr);
   void ld1(VectorFormat vform, LogicVRegister dst, int index, uint64_t addr);
   void ld1r(VectorFormat vform, LogicVRegister dst, uint64_t addr);
@@ -4404,6 +5305,15 @@ class Simulator : public DecoderVisitor {
                    bool is_signed = false);
 
   // SVE helpers -------------------------------------------
+
+  // Simple lane-wise operations, which have fast paths for common vector
+  // lengths. Like the instructions that use them, they do not saturate.
+  LogicVRegister SVEAddSubUnpredicatedHelper(AddSubOp op,
+                                             VectorFormat vform,
+                                             LogicVRegister zd,
+                                             const LogicVRegister& zn,
+                                             const LogicVRegister& zm);
+
   LogicVRegister SVEBitwiseLogicalUnpredicatedHelper(LogicalOp op,
                                                      VectorFormat vform,
                                                      LogicVRegister zd,
@@ -4457,6 +5367,55 @@ class Simulator : public DecoderVisitor {
                                const LogicSVEAddressVector& addr,
                                bool is_signed = false);
 
+  // Fast paths for the helpers above, for contiguous addressing. These access
+  // memory in blocks, one for each run of active structures. They return
+  // false, without accessing memory, if the span from the first to the last
+  // active structure touches a stack guard region; the slow path is then
+  // needed to report accurately whether any active element is in the guard
+  // region.
+  // `flags` describes the access for the memory trace.
+  bool SVEContiguousStoreHelper(VectorFormat vform,
+                                const LogicPRegister& pg,
+                                const LogicVRegister* zt,
+                                const LogicSVEAddressVector& addr,
+                                int flags);
+  bool SVEContiguousLoadHelper(VectorFormat vform,
+                               const LogicPRegister& pg,
+                               LogicVRegister* zt,
+                               const LogicSVEAddressVector& addr,
+                               bool is_signed,
+                               int flags);
+
+  static const int kMaxGatherScatterLanes =
+      kZRegMaxSizeInBytes / kSRegSizeInBytes;
+
+  // Fast paths for single-register gathers and scatters. The active element
+  // addresses are computed up-front and classified: contiguous elements are
+  // accessed as a block, elements with a constant stride are accessed in a
+  // simple loop, and elements that share an address are accessed only once.
+  // These return false, without accessing memory, if the contiguous block
+  // touches a stack guard region.
+  bool SVEGatherLoadHelper(VectorFormat vform,
+                           const LogicPRegister& pg,
+                           LogicVRegister zt,
+                           const LogicSVEAddressVector& addr,
+                           bool is_signed);
+  bool SVEScatterStoreHelper(VectorFormat vform,
+                             const LogicPRegister& pg,
+                             const LogicVRegister& zt,
+                             const LogicSVEAddressVector& addr);
+  // Compute the address of each active element in `addr`, recording the lane
+  // numbers in `lanes`, and update gather_scatter_stats_ to match. Returns the
+  // number of active elements, and sets `*stride` to the distance between the
+  // addresses of consecutive lanes if it is constant and non-zero, or to zero
+  // otherwise.
+  int GetGatherScatterAddresses(VectorFormat vform,
+                                const LogicPRegister& pg,
+                                const LogicSVEAddressVector& addr,
+                                uint64_t* addresses,
+                                int* lanes,
+                                int64_t* stride);
+
   enum SVEFaultTolerantLoadType {
     // - Elements active in both FFR and pg are accessed as usual. If the access
     //   fails, the corresponding lane and all subsequent lanes are filled with
@@ -4510,6 +5469,11 @@ class Simulator : public DecoderVisitor {
                               const LogicPRegister& pg,
                               const LogicPRegister& pn) const;
 
+  // Make the first `count` lanes of `dst` active, and the rest inactive.
+  LogicPRegister SetLeadingActiveLanes(VectorFormat vform,
+                                       LogicPRegister dst,
+                                       int count);
+
   // Count the number of lanes referred to by `pattern`, given the vector
   // length. If `pattern` is not a recognised SVEPredicateConstraint, this
   // returns zero.
@@ -4546,7 +5510,48 @@ class Simulator : public DecoderVisitor {
   // Program Status Register.
   // bits[31, 27]: Condition flags N, Z, C, and V.
   //               (Negative, Zero, Carry, Overflow)
-  SimSystemRegister nzcv_;
+  // This is out of date whilst lazy_nzcv_ holds an operation.
+  mutable SimSystemRegister nzcv_;
+
+  // Most flag results are overwritten before anything reads them, so integer
+  // arithmetic and logical instructions just record their operands here, and
+  // the flags are computed by the next ReadNzcv().
+  struct LazyNzcv {
+    enum Source {
+      // nzcv_ is up to date.
+      kNone,
+      // The flags from AddWithCarry(reg_size, true, left, right, carry_in).
+      kAddWithCarry,
+      // The flags from a logical operation: N and Z from `result`, and C and V
+      // clear.
+      kLogical
+    };
+
+    Source source;
+    unsigned reg_size;
+    uint64_t result;
+    uint64_t left;
+    uint64_t right;
+    int carry_in;
+  };
+  mutable LazyNzcv lazy_nzcv_;
+
+  void SetLazyNzcv(LazyNzcv::Source source,
+                   unsigned reg_size,
+                   uint64_t result,
+                   uint64_t left = 0,
+                   uint64_t right = 0,
+                   int carry_in = 0) {
+    lazy_nzcv_.source = source;
+    lazy_nzcv_.reg_size = reg_size;
+    lazy_nzcv_.result = result;
+    lazy_nzcv_.left = left;
+    lazy_nzcv_.right = right;
+    lazy_nzcv_.carry_in = carry_in;
+  }
+
+  // Compute nzcv_ from lazy_nzcv_.
+  void MaterialiseNzcv() const;
 
   // Floating-Point Control Register
   SimSystemRegister fpcr_;
@@ -4577,6 +5582,15 @@ class Simulator : public DecoderVisitor {
 
   Memory memory_;
 
+  // Checkpoint state.
+  SimDirtyPageTracker dirty_page_tracker_;
+  std::unique_ptr<SimCheckpoint> checkpoint_;
+
+  std::unique_ptr<SimWatchpoints> watchpoints_;
+  bool stopped_at_watchpoint_;
+
+  MemoryTraceWriter* memory_trace_;
+
   static const size_t kDefaultStackGuardStartSize = 0;
   static const size_t kDefaultStackGuardEndSize = 4 * 1024;
   static const size_t kDefaultStackUsableSize = 8 * 1024;
@@ -4587,6 +5601,32 @@ class Simulator : public DecoderVisitor {
   bool pc_modified_;
   const Instruction* pc_;
 
+  // The number of instructions executed since the last ResetState().
+  uint64_t executed_instruction_count_;
+
+  SimGatherScatterStats gather_scatter_stats_;
+
+  // A resolved runtime call site. See DoRuntimeCall().
+  struct RuntimeCallSite {
+    const Instruction* pc;
+    // The words inlined after the call site.
+    uintptr_t wrapper_address;
+    uintptr_t function;
+    uint32_t type_value;
+    // The entry for `function` in runtime_call_stats_.
+    SimRuntimeCallStats* stats;
+  };
+
+  // A direct-mapped cache of runtime call sites, indexed by pc.
+  static const int kRuntimeCallCacheSizeLog2 = 6;
+  static const int kRuntimeCallCacheSize = 1 << kRuntimeCallCacheSizeLog2;
+  RuntimeCallSite runtime_call_cache_[kRuntimeCallCacheSize];
+
+  // Elements of an unordered_map are never moved, so runtime_call_cache_ can
+  // hold pointers to them.
+  std::unordered_map<uintptr_t, SimRuntimeCallStats> runtime_call_stats_;
+  bool runtime_call_timing_;
+
   // If non-NULL, the last instruction was a movprfx, and validity needs to be
   // checked.
   Instruction const* movprfx_;
@@ -4711,6 +5751,11 @@ class Simulator : public DecoderVisitor {
 
   // A configurable size of SVE vector registers.
   unsigned vector_length_;
+
+  // Z and P registers are reset lazily. Incrementing these counters resets
+  // every register of the corresponding type.
+  uint64_t vregister_reset_generation_;
+  uint64_t pregister_reset_generation_;
 };
 
 #if defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT) && __cplusplus < 201402L
@@ -26,6 +26,10 @@
 
 extern "C" {
 #include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 }
 
 #include "code-buffer-vixl.h"
@@ -40,12 +44,25 @@ namespace vixl {
 #define MAP_ANONYMOUS MAP_ANON
 #endif
 
+// Dual mapping needs `memfd_create`, which older C libraries do not wrap, so
+// use the system call directly.
+#if defined(VIXL_CODE_BUFFER_MMAP) && defined(__linux__) && \
+    defined(__NR_memfd_create)
+#define VIXL_CODE_BUFFER_DUAL_MAPPING
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#endif
+
 CodeBuffer::CodeBuffer(size_t capacity)
     : buffer_(NULL),
       managed_(true),
       cursor_(NULL),
       dirty_(false),
-      capacity_(capacity) {
+      capacity_(capacity),
+      exec_buffer_(NULL),
+      memfd_(-1),
+      reserved_size_(0) {
   if (capacity_ == 0) {
     return;
   }
@@ -67,6 +84,7 @@ CodeBuffer::CodeBuffer(size_t capacity)
   VIXL_ASSERT(IsWordAligned(buffer_));
 
   cursor_ = buffer_;
+  exec_buffer_ = buffer_;
 }
 
 
@@ -75,7 +93,10 @@ CodeBuffer::CodeBuffer(byte* buffer, size_t capacity)
       managed_(false),
       cursor_(reinterpret_cast<byte*>(buffer)),
       dirty_(false),
-      capacity_(capacity) {
+      capacity_(capacity),
+      exec_buffer_(buffer_),
+      memfd_(-1),
+      reserved_size_(0) {
   VIXL_ASSERT(buffer_ != NULL);
 }
 
@@ -86,7 +107,11 @@ CodeBuffer::~CodeBuffer() VIXL_NEGATIVE_TESTING_ALLOW_EXCEPTION {
 #ifdef VIXL_CODE_BUFFER_MALLOC
     free(buffer_);
 #elif defined(VIXL_CODE_BUFFER_MMAP)
-    munmap(buffer_, capacity_);
+    munmap(buffer_, (reserved_size_ > 0) ? reserved_size_ : capacity_);
+    if (IsDualMapped()) {
+      munmap(exec_buffer_, capacity_);
+      close(memfd_);
+    }
 #else
 #error Unknown code buffer allocator.
 #endif
@@ -94,7 +119,82 @@ CodeBuffer::~CodeBuffer() VIXL_NEGATIVE_TESTING_ALLOW_EXCEPTION {
 }
 
 
+bool CodeBuffer::IsDualMappingSupported() {
+#ifdef VIXL_CODE_BUFFER_DUAL_MAPPING
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+void CodeBuffer::EnableDualMapping() {
+  VIXL_ASSERT(managed_);
+  VIXL_ASSERT(capacity_ > 0);
+  VIXL_ASSERT(GetSizeInBytes() == 0);
+  VIXL_ASSERT(!IsDualMapped());
+  VIXL_ASSERT(reserved_size_ == 0);
+#ifdef VIXL_CODE_BUFFER_DUAL_MAPPING
+  memfd_ = static_cast<int>(
+      syscall(__NR_memfd_create, "vixl-code-buffer", MFD_CLOEXEC));
+  VIXL_CHECK(memfd_ >= 0);
+  VIXL_CHECK(ftruncate(memfd_, capacity_) == 0);
+
+  // Both views are page-aligned, so page-relative offsets (as used by `adrp`)
+  // are the same whichever view they are computed from.
+  void* rw =
+      mmap(NULL, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, memfd_, 0);
+  VIXL_CHECK(rw != MAP_FAILED);
+  void* rx =
+      mmap(NULL, capacity_, PROT_READ | PROT_EXEC, MAP_SHARED, memfd_, 0);
+  VIXL_CHECK(rx != MAP_FAILED);
+
+  munmap(buffer_, capacity_);
+  buffer_ = reinterpret_cast<byte*>(rw);
+  exec_buffer_ = reinterpret_cast<byte*>(rx);
+  cursor_ = buffer_;
+#else
+  VIXL_ABORT_WITH_MSG(
+      "Dual-mapped code buffers require VIXL_CODE_BUFFER_MMAP on Linux.\n");
+#endif
+}
+
+
+void CodeBuffer::ReserveAddressSpace(size_t size) {
+  VIXL_ASSERT(managed_);
+  VIXL_ASSERT(GetSizeInBytes() == 0);
+  VIXL_ASSERT(!IsDualMapped());
+  VIXL_ASSERT(reserved_size_ == 0);
+  VIXL_ASSERT(size >= capacity_);
+#ifdef VIXL_CODE_BUFFER_MMAP
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+  flags |= MAP_NORESERVE;
+#endif
+  void* reservation = mmap(NULL, size, PROT_NONE, flags, -1, 0);
+  VIXL_CHECK(reservation != MAP_FAILED);
+  if (capacity_ > 0) {
+    int ret = mprotect(reservation, capacity_, PROT_READ | PROT_WRITE);
+    VIXL_CHECK(ret == 0);
+  }
+
+  if (buffer_ != NULL) munmap(buffer_, capacity_);
+  buffer_ = reinterpret_cast<byte*>(reservation);
+  exec_buffer_ = buffer_;
+  cursor_ = buffer_;
+  reserved_size_ = size;
+#else
+  USE(size);
+  VIXL_ABORT_WITH_MSG(
+      "Reserving address space for a code buffer requires "
+      "VIXL_CODE_BUFFER_MMAP.\n");
+#endif
+}
+
+
 void CodeBuffer::SetExecutable() {
+  // The executable view of a dual-mapped buffer is always executable.
+  if (IsDualMapped()) return;
 #ifdef VIXL_CODE_BUFFER_MMAP
   int ret = mprotect(buffer_, capacity_, PROT_READ | PROT_EXEC);
   VIXL_CHECK(ret == 0);
@@ -107,6 +207,8 @@ void CodeBuffer::SetExecutable() {
 
 
 void CodeBuffer::SetWritable() {
+  // The writable view of a dual-mapped buffer is always writable.
+  if (IsDualMapped()) return;
 #ifdef VIXL_CODE_BUFFER_MMAP
   int ret = mprotect(buffer_, capacity_, PROT_READ | PROT_WRITE);
   VIXL_CHECK(ret == 0);
@@ -177,20 +279,36 @@ void CodeBuffer::Grow(size_t new_capacity) {
   buffer_ = static_cast<byte*>(realloc(buffer_, new_capacity));
   VIXL_CHECK(buffer_ != NULL);
 #elif defined(VIXL_CODE_BUFFER_MMAP)
+  if (reserved_size_ > 0) {
+    // Commit more of the reservation. The buffer does not move.
+    if (new_capacity > reserved_size_) new_capacity = reserved_size_;
+    VIXL_CHECK(new_capacity > capacity_);
+    int ret = mprotect(buffer_, new_capacity, PROT_READ | PROT_WRITE);
+    VIXL_CHECK(ret == 0);
+  } else {
 #ifdef __APPLE__
-  // TODO: Avoid using VIXL_CODE_BUFFER_MMAP.
-  // Don't use false to avoid having the compiler realize it's a noreturn
-  // method.
-  VIXL_ASSERT(!managed_);
+    // TODO: Avoid using VIXL_CODE_BUFFER_MMAP.
+    // Don't use false to avoid having the compiler realize it's a noreturn
+    // method.
+    VIXL_ASSERT(!managed_);
 #else
-  buffer_ = static_cast<byte*>(
-      mremap(buffer_, capacity_, new_capacity, MREMAP_MAYMOVE));
-  VIXL_CHECK(buffer_ != MAP_FAILED);
+    if (IsDualMapped()) {
+      // Grow the backing file first, then both views of it.
+      VIXL_CHECK(ftruncate(memfd_, new_capacity) == 0);
+      exec_buffer_ = static_cast<byte*>(
+          mremap(exec_buffer_, capacity_, new_capacity, MREMAP_MAYMOVE));
+      VIXL_CHECK(exec_buffer_ != MAP_FAILED);
+    }
+    buffer_ = static_cast<byte*>(
+        mremap(buffer_, capacity_, new_capacity, MREMAP_MAYMOVE));
+    VIXL_CHECK(buffer_ != MAP_FAILED);
 #endif
+  }
 #else
 #error Unknown code buffer allocator.
 #endif
 
+  if (!IsDualMapped()) exec_buffer_ = buffer_;
   cursor_ = buffer_ + cursor_offset;
   capacity_ = new_capacity;
 }
@@ -51,6 +51,26 @@ class CodeBuffer {
   void SetExecutable();
   void SetWritable();
 
+  // Back the buffer with two views of the same memory: a permanently writable
+  // view, through which code is emitted and patched, and a permanently
+  // executable view, from which it is run. SetExecutable() and SetWritable()
+  // then have no effect, so live code can be patched without changing any page
+  // permissions.
+  // This must be called on an empty, managed buffer, and requires
+  // VIXL_CODE_BUFFER_MMAP on Linux; see IsDualMappingSupported().
+  void EnableDualMapping();
+  static bool IsDualMappingSupported();
+  bool IsDualMapped() const { return memfd_ >= 0; }
+
+  // Reserve `size` bytes of address space for the buffer, so that it grows in
+  // place, without moving or copying the code already emitted, until it reaches
+  // that size. Only the current capacity is committed; more of the reservation
+  // is committed as the buffer grows, and it cannot grow beyond it.
+  // This must be called on an empty, managed buffer, and requires
+  // VIXL_CODE_BUFFER_MMAP. It cannot be combined with dual mapping.
+  void ReserveAddressSpace(size_t size);
+  size_t GetReservedSize() const { return reserved_size_; }
+
   ptrdiff_t GetOffsetFrom(ptrdiff_t offset) const {
     ptrdiff_t cursor_offset = cursor_ - buffer_;
     VIXL_ASSERT((offset >= 0) && (offset <= cursor_offset));
@@ -79,6 +99,21 @@ class CodeBuffer {
     return reinterpret_cast<T>(buffer_ + offset);
   }
 
+  // Return the address at which the code at `offset` will be executed. This is
+  // the same as GetOffsetAddress() unless the buffer is dual-mapped.
+  template <typename T>
+  T GetExecutableOffsetAddress(ptrdiff_t offset) const {
+    VIXL_STATIC_ASSERT(sizeof(T) >= sizeof(uintptr_t));
+    VIXL_ASSERT((offset >= 0) && (offset <= (cursor_ - buffer_)));
+    return reinterpret_cast<T>(exec_buffer_ + offset);
+  }
+
+  template <typename T>
+  T GetExecutableStartAddress() const {
+    VIXL_STATIC_ASSERT(sizeof(T) >= sizeof(uintptr_t));
+    return GetExecutableOffsetAddress<T>(0);
+  }
+
   // Return the address of the start or end of the emitted code.
   template <typename T>
   T GetStartAddress() const {
@@ -147,6 +182,8 @@ class CodeBuffer {
 
   bool IsManaged() const { return managed_; }
 
+  // Grow the backing store. With VIXL_CODE_BUFFER_MMAP, this remaps (or, for a
+  // reserved buffer, commits) pages rather than copying the emitted code.
   void Grow(size_t new_capacity);
 
   bool IsDirty() const { return dirty_; }
@@ -159,7 +196,11 @@ class CodeBuffer {
 
   void EnsureSpaceFor(size_t amount, bool* has_grown) {
     bool is_full = !HasSpaceFor(amount);
-    if (is_full) Grow(capacity_ * 2 + amount);
+    if (is_full) {
+      Grow(capacity_ * 2 + amount);
+      // A reserved buffer may not have been able to grow far enough.
+      VIXL_CHECK(HasSpaceFor(amount));
+    }
     VIXL_ASSERT(has_grown != NULL);
     *has_grown = is_full;
   }
@@ -181,6 +222,14 @@ class CodeBuffer {
   bool dirty_;
   // Capacity in bytes of the backing store.
   size_t capacity_;
+  // Executable view of the backing store. This is the same as buffer_ unless
+  // the buffer is dual-mapped.
+  byte* exec_buffer_;
+  // File descriptor backing both views of a dual-mapped buffer, or -1.
+  int memfd_;
+  // Size in bytes of the address space reserved for the buffer, or 0 if the
+  // backing store is not a reservation.
+  size_t reserved_size_;
 };
 
 }  // namespace vixl
@@ -2255,6 +2255,112 @@ TEST(adrp_offset) {
 }
 
 
+TEST(adr_dual_mapped) {
+  if (!CodeBuffer::IsDualMappingSupported()) return;
+
+  SETUP_CUSTOM(2 * kPageSize, PageOffsetDependentCode);
+  masm.GetBuffer()->EnableDualMapping();
+
+  Label start;
+  START();
+  __ Bind(&start);
+  // Label addresses should be those of the executable view.
+  __ Adr(x0, &start);
+  {
+    ExactAssemblyScope scope(&masm, kInstructionSize);
+    __ adrp(x1, &start);
+  }
+  // Literals are loaded relative to the executable view.
+  __ Ldr(x2, 0x0123456789abcdef);
+  END();
+
+  if (CAN_RUN()) {
+    RUN();
+
+    uint64_t exec_start =
+        masm.GetBuffer()->GetExecutableOffsetAddress<uint64_t>(
+            start.GetLocation());
+    ASSERT_EQUAL_64(exec_start, x0);
+    ASSERT_EQUAL_64(AlignDown(exec_start, kPageSize), x1);
+    ASSERT_EQUAL_64(0x0123456789abcdef, x2);
+  }
+}
+
+
+// Copy the code generated by `masm` into `copy`, at `offset`, and relocate it.
+// Return the address of the copy.
+static byte* CopyAndRelocate(MacroAssembler* masm,
+                             CodeBuffer* copy,
+                             size_t offset) {
+  size_t size = masm->GetSizeOfCodeGenerated();
+  copy->EmitZeroedBytes(static_cast<int>(offset + size));
+  byte* code = copy->GetOffsetAddress<byte*>(offset);
+  CopyAndRelocateCode(code,
+                      reinterpret_cast<uintptr_t>(code),
+                      masm->GetBuffer()->GetStartAddress<const void*>(),
+                      size,
+                      masm->GetRelocations());
+  copy->SetClean();
+  return code;
+}
+
+
+TEST(relocate_adrp) {
+  SETUP_CUSTOM(2 * kPageSize, PageOffsetDependentCode);
+  masm.SetRecordRelocations(true);
+
+  Label start, later;
+  START();
+  __ Bind(&start);
+  __ Adr(x0, &start);
+  {
+    ExactAssemblyScope scope(&masm, 2 * kInstructionSize);
+    __ adrp(x1, &start);
+    // The label is not bound yet.
+    __ adrp(x2, &later);
+  }
+  __ Ldr(x3, 0x0123456789abcdef);
+  __ Bind(&later);
+  END();
+
+  const std::vector<Relocation>& relocations = masm.GetRelocations();
+  VIXL_CHECK(relocations.size() == 2);
+  VIXL_CHECK(relocations[0].kind == Relocation::kAdrpInternal);
+  VIXL_CHECK(relocations[0].target ==
+             static_cast<uint64_t>(start.GetLocation()));
+  VIXL_CHECK(relocations[1].kind == Relocation::kAdrpInternal);
+  VIXL_CHECK(relocations[1].target ==
+             static_cast<uint64_t>(later.GetLocation()));
+
+  if (CAN_RUN()) {
+    // Move the code so that `start` is in a different page to the first adrp,
+    // which it was not in the original code.
+    VIXL_ASSERT(IsAligned(masm.GetBuffer()->GetStartAddress<uintptr_t>(),
+                          kPageSize));
+    size_t offset = kPageSize - start.GetLocation() - kInstructionSize;
+    CodeBuffer copy(2 * kPageSize + masm.GetSizeOfCodeGenerated());
+    byte* code = CopyAndRelocate(&masm, &copy, offset);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+    simulator.RunFrom(reinterpret_cast<Instruction*>(code));
+#else
+    copy.SetExecutable();
+    ExecuteMemory(code, masm.GetSizeOfCodeGenerated());
+    copy.SetWritable();
+#endif
+
+    uint64_t new_start = reinterpret_cast<uint64_t>(code) + start.GetLocation();
+    uint64_t new_later = reinterpret_cast<uint64_t>(code) + later.GetLocation();
+    VIXL_CHECK(AlignDown(new_start, kPageSize) !=
+               AlignDown(new_start + kInstructionSize, kPageSize));
+    ASSERT_EQUAL_64(new_start, x0);
+    ASSERT_EQUAL_64(AlignDown(new_start, kPageSize), x1);
+    ASSERT_EQUAL_64(AlignDown(new_later, kPageSize), x2);
+    ASSERT_EQUAL_64(0x0123456789abcdef, x3);
+  }
+}
+
+
 TEST(branch_cond) {
   SETUP();
 
@@ -3885,6 +3991,59 @@ TEST(ldr_literal_range) {
 }
 
 
+TEST(ldr_literal_shared) {
+  SETUP_WITH_FEATURES(CPUFeatures::kNEON);
+
+  START();
+  // Make sure the pool is empty;
+  masm.EmitLiteralPool(LiteralPool::kBranchRequired);
+  ASSERT_LITERAL_POOL_SIZE(0);
+
+  // Loads of the same value share a single pool entry.
+  __ Ldr(x0, 0x1234567890abcdef);
+  __ Ldr(x1, 0x1234567890abcdef);
+  __ Ldr(d0, 1.234);
+  __ Ldr(d1, 1.234);
+  __ Ldr(w2, 0x80000000);
+  __ Ldrsw(x3, 0x80000000);
+  __ Ldr(q2, 0x1234000056780000, 0xabcd0000ef000000);
+  __ Ldr(q3, 0x1234000056780000, 0xabcd0000ef000000);
+  ASSERT_LITERAL_POOL_SIZE(36);
+
+  // Literals created by the user are never shared.
+  Literal<uint64_t> user_literal(0x1234567890abcdef, masm.GetLiteralPool());
+  __ Ldr(x4, &user_literal);
+  ASSERT_LITERAL_POOL_SIZE(44);
+  masm.EmitLiteralPool(LiteralPool::kBranchRequired);
+  ASSERT_LITERAL_POOL_SIZE(0);
+
+  // Placed literals are still shared while they are close enough.
+  __ Ldr(x5, 0x1234567890abcdef);
+  __ Ldr(s4, 2.5);
+  ASSERT_LITERAL_POOL_SIZE(4);
+  __ Ldr(q5, 0x1234000056780000, 0xabcd0000ef000000);
+  ASSERT_LITERAL_POOL_SIZE(4);
+  END();
+
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_64(0x1234567890abcdef, x0);
+    ASSERT_EQUAL_64(0x1234567890abcdef, x1);
+    ASSERT_EQUAL_FP64(1.234, d0);
+    ASSERT_EQUAL_FP64(1.234, d1);
+    ASSERT_EQUAL_64(0x80000000, x2);
+    ASSERT_EQUAL_64(0xffffffff80000000, x3);
+    ASSERT_EQUAL_128(0x1234000056780000, 0xabcd0000ef000000, q2);
+    ASSERT_EQUAL_128(0x1234000056780000, 0xabcd0000ef000000, q3);
+    ASSERT_EQUAL_64(0x1234567890abcdef, x4);
+    ASSERT_EQUAL_64(0x1234567890abcdef, x5);
+    ASSERT_EQUAL_FP32(2.5, s4);
+    ASSERT_EQUAL_128(0x1234000056780000, 0xabcd0000ef000000, q5);
+  }
+}
+
+
 template <typename T>
 void LoadIntValueHelper(T values[], int card) {
   SETUP();
@@ -12925,7 +13084,10 @@ TEST(collision_literal_veneer_pools) {
     // Use a different value to force one literal pool entry per iteration.
     __ Ldr(s0, i + 0.1);
   }
-  VIXL_CHECK(masm.GetLiteralPoolSize() >= target_literal_pool_size);
+  // As the literal pool grows, the `tbz` needs a veneer. The literals generated
+  // so far are emitted in the same pool as the veneer.
+  VIXL_CHECK(masm.GetNumberOfPotentialVeneers() == 0);
+  VIXL_CHECK(masm.GetLiteralPoolSize() < target_literal_pool_size);
 
   // Force emission of a literal pool.
   masm.EmitLiteralPool(LiteralPool::kBranchRequired);
@@ -12941,6 +13103,48 @@ TEST(collision_literal_veneer_pools) {
 }
 
 
+TEST(veneers_and_literals_share_pool) {
+  SETUP();
+  START();
+
+  Label target;
+
+  __ Mov(x0, 0);
+  __ Mov(x2, 0);
+  __ Ldr(x1, 0x0123456789abcdef);
+  __ Tbz(x0, 7, &target);
+  VIXL_CHECK(masm.GetNumberOfPotentialVeneers() == 1);
+  VIXL_CHECK(masm.GetLiteralPoolSize() > 0);
+
+  // Generate code until the veneer for the `tbz` is emitted. The literal pool
+  // is not due yet, but is emitted with it, behind the same branch.
+  ptrdiff_t pool_start;
+  do {
+    pool_start = masm.GetCursorOffset();
+    __ Nop();
+  } while (masm.GetNumberOfPotentialVeneers() > 0);
+  ASSERT_LITERAL_POOL_SIZE(0);
+
+  const ptrdiff_t kPoolSize = kInstructionSize +  // Branch over the pool.
+                              kInstructionSize +  // Literal pool header.
+                              sizeof(uint64_t) +  // The literal.
+                              kInstructionSize;   // The veneer.
+  VIXL_CHECK((masm.GetCursorOffset() - pool_start) ==
+             (kPoolSize + kInstructionSize));
+
+  __ Bind(&target);
+  __ Mov(x2, 1);
+
+  END();
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_64(0x0123456789abcdef, x1);
+    ASSERT_EQUAL_64(1, x2);
+  }
+}
+
+
 TEST(ldr_literal_explicit) {
   SETUP();
 
@@ -13380,6 +13584,55 @@ TEST(runtime_calls) {
   }
 #endif  // #if defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT) || ...
 }
+
+
+TEST(relocate_runtime_call) {
+  SETUP();
+
+#ifndef VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT
+  if (masm.GenerateSimulatorCode()) return;
+#endif
+
+  masm.SetRecordRelocations(true);
+  START();
+  __ Mov(w0, 41);
+  __ CallRuntime(runtime_call_add_one);
+  __ Mov(w20, w0);
+  END();
+
+  // The function address (and, for the simulator, the wrapper address) must be
+  // recorded.
+  const std::vector<Relocation>& relocations = masm.GetRelocations();
+  uint64_t function = reinterpret_cast<uint64_t>(runtime_call_add_one);
+  if (masm.GenerateSimulatorCode()) {
+    VIXL_CHECK(relocations.size() == 2);
+    VIXL_CHECK(relocations[0].kind == Relocation::kAbsolute64);
+    VIXL_CHECK(relocations[1].kind == Relocation::kAbsolute64);
+    VIXL_CHECK(relocations[1].target == function);
+  } else {
+    VIXL_CHECK(relocations.size() == 1);
+    VIXL_CHECK(relocations[0].kind == Relocation::kMovWide64);
+    VIXL_CHECK(relocations[0].target == function);
+  }
+
+#if defined(VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT) || \
+    !defined(VIXL_INCLUDE_SIMULATOR_AARCH64)
+  if (CAN_RUN()) {
+    CodeBuffer copy(kPageSize + masm.GetSizeOfCodeGenerated());
+    byte* code = CopyAndRelocate(&masm, &copy, 0x100);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+    simulator.RunFrom(reinterpret_cast<Instruction*>(code));
+#else
+    copy.SetExecutable();
+    ExecuteMemory(code, masm.GetSizeOfCodeGenerated());
+    copy.SetWritable();
+#endif
+
+    ASSERT_EQUAL_32(42, w20);
+  }
+#endif
+}
 #endif  // #ifdef VIXL_HAS_MACROASSEMBLER_RUNTIME_CALL_SUPPORT
 
 
@@ -13600,6 +13853,507 @@ TEST(large_sim_stack) {
   }
 }
 
+TEST(sim_run_for) {
+  SETUP();
+  START();
+
+  __ Mov(x0, 1000);
+  __ Mov(x1, 0);
+  Label loop;
+  __ Bind(&loop);
+  __ Add(x1, x1, 2);
+  __ Sub(x0, x0, 1);
+  __ Cbnz(x0, &loop);
+
+  END();
+  if (CAN_RUN()) {
+    simulator.WritePc(masm.GetBuffer()->GetStartAddress<Instruction*>(),
+                      Simulator::NoBranchLog);
+    int slices = 0;
+    uint64_t previous_count = simulator.GetExecutedInstructionCount();
+    while (!simulator.RunFor(100)) {
+      // Each slice should stop at the first basic block boundary after the
+      // budget is exhausted.
+      uint64_t count = simulator.GetExecutedInstructionCount();
+      VIXL_CHECK(count - previous_count >= 100);
+      VIXL_CHECK(count - previous_count <= 103);
+      previous_count = count;
+      slices++;
+    }
+    VIXL_CHECK(slices >= 29);
+    VIXL_CHECK(simulator.IsFinished());
+
+    ASSERT_EQUAL_64(0, x0);
+    ASSERT_EQUAL_64(2000, x1);
+  }
+}
+
+TEST(sim_run_for_infinite_loop) {
+  SETUP();
+  START();
+
+  __ Mov(x0, 0);
+  Label loop;
+  __ Bind(&loop);
+  __ Add(x0, x0, 1);
+  __ B(&loop);
+
+  END();
+  if (CAN_RUN()) {
+    simulator.WritePc(masm.GetBuffer()->GetStartAddress<Instruction*>(),
+                      Simulator::NoBranchLog);
+    VIXL_CHECK(!simulator.RunFor(1000));
+    VIXL_CHECK(!simulator.IsFinished());
+    // Execution can be resumed where it stopped.
+    int64_t x0_value = simulator.ReadXRegister(0);
+    VIXL_CHECK(!simulator.RunFor(1000));
+    VIXL_CHECK(simulator.ReadXRegister(0) >= x0_value + 500);
+  }
+}
+
+TEST(sim_checkpoint) {
+  uint64_t data[1024] = {};
+  uintptr_t data_address = reinterpret_cast<uintptr_t>(data);
+  // `data[0]` and `data[page_stride]` are on different pages.
+  const int page_stride = kPageSize / sizeof(data[0]);
+
+  SETUP_WITH_FEATURES(CPUFeatures::kSVE);
+  simulator.RegisterCheckpointMemory(data, sizeof(data));
+  START();
+
+  __ Mov(x0, data_address);
+  __ Ldr(x1, MemOperand(x0));
+  __ Add(x1, x1, 1);
+  __ Str(x1, MemOperand(x0));
+  __ Str(x1, MemOperand(x0, page_stride * sizeof(data[0])));
+  __ Index(z0.VnD(), x1, 1);
+  __ Cmp(x1, 1);
+  __ Cset(x2, eq);
+
+  END();
+  if (CAN_RUN()) {
+    simulator.WritePc(masm.GetBuffer()->GetStartAddress<Instruction*>(),
+                      Simulator::NoBranchLog);
+    simulator.SaveCheckpoint();
+    VIXL_CHECK(simulator.HasCheckpoint());
+
+    for (int i = 0; i < 3; i++) {
+      simulator.Run();
+      VIXL_CHECK(simulator.IsFinished());
+      VIXL_CHECK((data[0] == 1) && (data[page_stride] == 1));
+      // Both pages of `data` are dirty, as is the simulated stack.
+      VIXL_CHECK(simulator.GetCheckpointDirtyPageCount() >= 3);
+
+      // Without the restore, each iteration would increment `data[0]`.
+      ASSERT_EQUAL_64(1, x1);
+      ASSERT_EQUAL_64(1, x2);
+      uint64_t z0_expected[] = {0x0000000000000002, 0x0000000000000001};
+      ASSERT_EQUAL_SVE(z0_expected, z0.VnD());
+
+      simulator.RestoreCheckpoint();
+      VIXL_CHECK(!simulator.IsFinished());
+      VIXL_CHECK((data[0] == 0) && (data[page_stride] == 0));
+      VIXL_CHECK(simulator.GetCheckpointDirtyPageCount() == 0);
+    }
+
+    simulator.DiscardCheckpoint();
+    VIXL_CHECK(!simulator.HasCheckpoint());
+  }
+}
+
+TEST(sim_lazy_register_reset) {
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.SetVectorLengthInBits(kZRegMaxSize);
+
+  simulator.ReadVRegister(3).Insert(0, UINT64_C(42));
+  simulator.ReadPRegister(5).Insert(0, static_cast<uint16_t>(42));
+  SimVRegister z3_copy = simulator.ReadVRegister(3);
+  VIXL_CHECK(z3_copy.GetLane<uint64_t>(0) == 42);
+  VIXL_CHECK(z3_copy.GetLane<uint64_t>(1) == UINT64_C(0x7ff0f0037f80f001));
+
+  for (int i = 0; i < 2; i++) {
+    simulator.ResetState();
+    VIXL_CHECK(simulator.ReadVRegister(3).WrittenSinceLastLog());
+    VIXL_CHECK(simulator.ReadVRegister(3).AccessedAsZSinceLastLog());
+
+    // Each lane is reset on first access, with the register number and lane
+    // index encoded into the value.
+    SimVRegister& z3 = simulator.ReadVRegister(3);
+    VIXL_CHECK(z3.GetLane<uint64_t>(0) == UINT64_C(0x7ff0f0037f80f000));
+    VIXL_CHECK(z3.GetLane<uint64_t>(31) == UINT64_C(0x7ff0f0037f80f01f));
+    SimPRegister& p5 = simulator.ReadPRegister(5);
+    VIXL_CHECK(p5.GetLane<uint16_t>(0) == 0x0005);
+    VIXL_CHECK(p5.GetLane<uint16_t>(15) == 0x0f05);
+
+    // Copies taken before the reset keep their value.
+    VIXL_CHECK(z3_copy.GetLane<uint64_t>(0) == 42);
+  }
+
+  // Changing the vector length resets the registers at the new size.
+  simulator.ReadVRegister(7).Insert(1, UINT64_C(42));
+  simulator.SetVectorLengthInBits(kZRegMinSize);
+  VIXL_CHECK(simulator.ReadVRegister(7).GetSizeInBits() == kZRegMinSize);
+  VIXL_CHECK(simulator.ReadVRegister(7).GetLane<uint64_t>(1) ==
+             UINT64_C(0x7ff0f0077f80f001));
+}
+
+TEST(sim_lazy_nzcv) {
+  SETUP();
+  START();
+
+  __ Mov(x0, 0x8000000000000000);
+  __ Mov(x1, 1);
+  // Flags which are overwritten without being read.
+  __ Cmp(x0, x1);
+  __ Ands(x2, x0, x1);
+  __ Cset(x10, eq);
+  // Partially update lazily-computed flags.
+  __ Subs(x3, x0, x1);
+  __ Ccmp(x1, 2, NoFlag, mi);
+  __ Mrs(x11, NZCV);
+  // Leave the flags from an addition for the host to read.
+  __ Adds(x4, x0, x0);
+
+  END();
+  if (CAN_RUN()) {
+    RUN();
+    ASSERT_EQUAL_64(1, x10);
+    ASSERT_EQUAL_64(NoFlag, x11);
+    ASSERT_EQUAL_NZCV(ZCVFlag);
+
+    const Simulator& const_simulator = simulator;
+    VIXL_CHECK(!const_simulator.ReadN());
+    VIXL_CHECK(const_simulator.ReadZ());
+    VIXL_CHECK(const_simulator.ReadC());
+    VIXL_CHECK(const_simulator.ReadV());
+  }
+}
+
+TEST(sim_guest_memory) {
+  uint64_t host_data[2] = {1, 2};
+  uintptr_t host_data_address = reinterpret_cast<uintptr_t>(host_data);
+  const uint64_t guest_base = 0x10000;
+
+  SETUP();
+  SimGuestMemory guest;
+  // The register dump is written by simulated code, so it must be mapped too.
+  guest.MapRegion(reinterpret_cast<uintptr_t>(&core),
+                  &core,
+                  sizeof(core),
+                  SimGuestMemory::kReadWrite);
+  guest.MapRegion(host_data_address,
+                  host_data,
+                  sizeof(host_data),
+                  SimGuestMemory::kRead);
+  void* guest_region = guest.AllocateRegion(guest_base,
+                                            2 * kPageSize,
+                                            SimGuestMemory::kReadWrite);
+  char* guest_data = static_cast<char*>(guest_region);
+  simulator.SetGuestMemory(&guest);
+  START();
+
+  __ Mov(x0, host_data_address);
+  __ Mov(x1, guest_base);
+  __ Ldp(x2, x3, MemOperand(x0));
+  __ Add(x2, x2, x3);
+  __ Str(x2, MemOperand(x1, 8));
+  // This access crosses a page boundary.
+  __ Str(x2, MemOperand(x1, kPageSize - 4));
+  __ Ldr(x4, MemOperand(x1, kPageSize - 4));
+
+  END();
+  if (CAN_RUN()) {
+    RUN();
+    ASSERT_EQUAL_64(3, x2);
+    ASSERT_EQUAL_64(3, x4);
+
+    uint64_t value;
+    memcpy(&value, guest_data + 8, sizeof(value));
+    VIXL_CHECK(value == 3);
+    VIXL_CHECK(guest.Read(guest_base + kPageSize - 4, &value, sizeof(value)));
+    VIXL_CHECK(value == 3);
+
+    // Writes made after a snapshot don't reach the host memory until the
+    // snapshot is discarded.
+    guest.TakeSnapshot();
+    uint64_t new_value = 42;
+    VIXL_CHECK(guest.Write(guest_base + 8, &new_value, sizeof(new_value)));
+    VIXL_CHECK(guest.GetCopiedPageCount() == 1);
+    VIXL_CHECK(guest.Read(guest_base + 8, &value, sizeof(value)));
+    VIXL_CHECK(value == 42);
+    memcpy(&value, guest_data + 8, sizeof(value));
+    VIXL_CHECK(value == 3);
+
+    guest.RestoreSnapshot();
+    VIXL_CHECK(guest.GetCopiedPageCount() == 0);
+    VIXL_CHECK(guest.Read(guest_base + 8, &value, sizeof(value)));
+    VIXL_CHECK(value == 3);
+
+    VIXL_CHECK(guest.Write(guest_base + 8, &new_value, sizeof(new_value)));
+    guest.DiscardSnapshot();
+    VIXL_CHECK(!guest.IsSnapshotActive());
+    memcpy(&value, guest_data + 8, sizeof(value));
+    VIXL_CHECK(value == 42);
+
+    // Permissions.
+    VIXL_CHECK(!guest.Write(host_data_address, &new_value, sizeof(new_value)));
+    VIXL_CHECK(!guest.IsAccessible(guest_base + (2 * kPageSize),
+                                   1,
+                                   SimGuestMemory::kRead));
+    guest.SetRegionPermissions(guest_base, SimGuestMemory::kRead);
+    VIXL_CHECK(guest.IsAccessible(guest_base, 8, SimGuestMemory::kRead));
+    VIXL_CHECK(!guest.IsAccessible(guest_base, 8, SimGuestMemory::kWrite));
+    guest.UnmapRegion(guest_base);
+    VIXL_CHECK(!guest.IsAccessible(guest_base, 8, SimGuestMemory::kRead));
+  }
+}
+
+TEST(sim_watchpoints) {
+  uint64_t data[4] = {1, 2, 3, 4};
+  uintptr_t data_address = reinterpret_cast<uintptr_t>(data);
+
+  SETUP();
+  SimWatchpoints* watchpoints = simulator.GetWatchpoints();
+  watchpoints->Add(data_address + 8, 8, SimWatchpoints::kWrite);
+  watchpoints->Add(data_address + 16, 8, SimWatchpoints::kRead, true);
+  START();
+
+  Label store, load;
+  __ Mov(x0, data_address);
+  __ Mov(x1, 0x1234);
+  __ Mov(x4, 0);
+  __ Bind(&store);
+  __ Str(x1, MemOperand(x0, 8));
+  // Neither of these hit a watchpoint.
+  __ Ldr(x2, MemOperand(x0));
+  __ Ldr(x2, MemOperand(x0, 8));
+  // This touches both watched ranges, but only one is watched for reads.
+  __ Bind(&load);
+  __ Ldp(x2, x3, MemOperand(x0, 8));
+  __ Mov(x4, 42);
+
+  END();
+  if (CAN_RUN()) {
+    simulator.WritePc(masm.GetBuffer()->GetStartAddress<Instruction*>(),
+                      Simulator::NoBranchLog);
+    simulator.Run();
+    VIXL_CHECK(!simulator.IsFinished());
+    VIXL_CHECK(simulator.IsStoppedAtWatchpoint());
+    // The simulator stops after the instruction that hit the watchpoint.
+    VIXL_CHECK(simulator.ReadXRegister(3) == 3);
+    VIXL_CHECK(simulator.ReadXRegister(4) == 0);
+
+    VIXL_CHECK(watchpoints->GetHitCount() == 2);
+    VIXL_CHECK(watchpoints->GetLoggedHitCount() == 2);
+    const SimWatchpointHit& write = watchpoints->GetLoggedHit(0);
+    VIXL_CHECK(write.pc == masm.GetLabelAddress<uint64_t>(&store));
+    VIXL_CHECK(write.address == data_address + 8);
+    VIXL_CHECK(write.value == 0x1234);
+    VIXL_CHECK(write.size == 8);
+    VIXL_CHECK(write.access == SimWatchpoints::kWrite);
+    const SimWatchpointHit& read = watchpoints->GetLoggedHit(1);
+    VIXL_CHECK(read.pc == masm.GetLabelAddress<uint64_t>(&load));
+    VIXL_CHECK(read.address == data_address + 16);
+    VIXL_CHECK(read.value == 3);
+    VIXL_CHECK(read.access == SimWatchpoints::kRead);
+
+    simulator.Run();
+    VIXL_CHECK(simulator.IsFinished());
+    VIXL_CHECK(!simulator.IsStoppedAtWatchpoint());
+    ASSERT_EQUAL_64(0x1234, x2);
+    ASSERT_EQUAL_64(3, x3);
+    ASSERT_EQUAL_64(42, x4);
+  }
+}
+
+TEST(sim_watchpoint_log_overflow) {
+  SimWatchpoints watchpoints(4);
+  watchpoints.Add(0x1000, 16, SimWatchpoints::kReadWrite);
+  VIXL_CHECK(watchpoints.MightHit(0x1008, 4));
+  VIXL_CHECK(!watchpoints.MightHit(0x3000, 4));
+
+  for (uint64_t i = 0; i < 6; i++) {
+    watchpoints.Check(i, 0x1000 + i, &i, 1, SimWatchpoints::kWrite);
+  }
+  // Misses aren't logged.
+  watchpoints.Check(6, 0x1010, &watchpoints, 1, SimWatchpoints::kRead);
+
+  VIXL_CHECK(watchpoints.GetHitCount() == 6);
+  VIXL_CHECK(watchpoints.GetLoggedHitCount() == 4);
+  for (size_t i = 0; i < 4; i++) {
+    VIXL_CHECK(watchpoints.GetLoggedHit(i).pc == i + 2);
+  }
+
+  watchpoints.Remove(0x1000);
+  VIXL_CHECK(!watchpoints.MightHit(0x1008, 4));
+}
+
+#ifdef VIXL_HAS_SIMULATED_RUNTIME_CALL_SUPPORT
+TEST(sim_runtime_call_stats) {
+  SETUP_WITH_FEATURES(CPUFeatures::kFP);
+  simulator.EnableRuntimeCallTiming();
+  START();
+
+  // Each call site is resolved once, then reused by every iteration.
+  Label loop;
+  __ Mov(w0, 0);
+  __ Mov(x19, 10);
+  __ Bind(&loop);
+  __ CallRuntime(runtime_call_add_one);
+  __ Sub(x19, x19, 1);
+  __ Cbnz(x19, &loop);
+  __ Mov(w20, w0);
+
+  __ Fmov(d0, 0.0);
+  __ Fmov(d1, 1.5);
+  __ Fmov(d2, 2.5);
+  __ CallRuntime(runtime_call_add_doubles);
+  // A second call site for the same function.
+  __ Mov(w0, w20);
+  __ CallRuntime(runtime_call_add_one);
+  __ Mov(w21, w0);
+
+  END();
+  if (CAN_RUN()) {
+    RUN();
+    ASSERT_EQUAL_32(10, w20);
+    ASSERT_EQUAL_32(11, w21);
+    ASSERT_EQUAL_FP64(4.0, d0);
+
+    const std::unordered_map<uintptr_t, SimRuntimeCallStats>& stats =
+        simulator.GetRuntimeCallStats();
+    VIXL_CHECK(stats.size() == 2);
+    uintptr_t add_one = reinterpret_cast<uintptr_t>(runtime_call_add_one);
+    uintptr_t add_doubles =
+        reinterpret_cast<uintptr_t>(runtime_call_add_doubles);
+    VIXL_CHECK(stats.at(add_one).calls == 11);
+    VIXL_CHECK(stats.at(add_doubles).calls == 1);
+
+    // Running the same code again uses the cached call sites.
+    simulator.RunFrom(masm.GetBuffer()->GetStartAddress<Instruction*>());
+    VIXL_CHECK(stats.at(add_one).calls == 22);
+    VIXL_CHECK(stats.at(add_doubles).calls == 2);
+
+    simulator.InvalidateRuntimeCallCache();
+    simulator.RunFrom(masm.GetBuffer()->GetStartAddress<Instruction*>());
+    VIXL_CHECK(stats.at(add_one).calls == 33);
+
+    simulator.ResetState();
+    VIXL_CHECK(simulator.GetRuntimeCallStats().empty());
+  }
+}
+
+// A call site can be replaced by a call to a different function, with a
+// different signature, at the same address. The simulator must notice this
+// without InvalidateRuntimeCallCache().
+TEST(sim_runtime_call_site_reused) {
+  SETUP_WITH_FEATURES(CPUFeatures::kFP);
+  // START() would reset the simulator, so this test generates its own code.
+  USE(offset_after_infrastructure_start);
+  USE(offset_before_infrastructure_end);
+  if (!CAN_RUN()) return;
+
+  masm.Reset();
+  __ Mov(w0, 41);
+  __ Nop();
+  __ Nop();
+  __ Push(lr, xzr);
+  ptrdiff_t first_call_offset = masm.GetCursorOffset();
+  __ CallRuntime(runtime_call_add_one);
+  __ Pop(xzr, lr);
+  __ Ret();
+  masm.FinalizeCode();
+
+  simulator.RunFrom(masm.GetBuffer()->GetStartAddress<Instruction*>());
+  VIXL_CHECK(simulator.ReadWRegister(0) == 42);
+
+  masm.Reset();
+  __ Fmov(d0, 0.5);
+  __ Fmov(d1, 1.5);
+  __ Fmov(d2, 2.5);
+  __ Push(lr, xzr);
+  VIXL_CHECK(masm.GetCursorOffset() == first_call_offset);
+  __ CallRuntime(runtime_call_add_doubles);
+  __ Pop(xzr, lr);
+  __ Ret();
+  masm.FinalizeCode();
+
+  simulator.RunFrom(masm.GetBuffer()->GetStartAddress<Instruction*>());
+  VIXL_CHECK(simulator.ReadDRegister(0) == 4.5);
+
+  const std::unordered_map<uintptr_t, SimRuntimeCallStats>& stats =
+      simulator.GetRuntimeCallStats();
+  uintptr_t add_one = reinterpret_cast<uintptr_t>(runtime_call_add_one);
+  uintptr_t add_doubles =
+      reinterpret_cast<uintptr_t>(runtime_call_add_doubles);
+  VIXL_CHECK(stats.at(add_one).calls == 1);
+  VIXL_CHECK(stats.at(add_doubles).calls == 1);
+}
+#endif
+
+TEST(sim_memory_trace) {
+  uint64_t data[4] = {1, 2, 3, 4};
+  uintptr_t data_address = reinterpret_cast<uintptr_t>(data);
+
+  FILE* stream = tmpfile();
+  VIXL_CHECK(stream != NULL);
+  // Use a small buffer, so that the trace is flushed while it is written.
+  MemoryTraceWriter writer(stream, 2);
+
+  SETUP_WITH_FEATURES(CPUFeatures::kNEON);
+  simulator.SetMemoryTrace(&writer);
+  START();
+
+  Label store, load;
+  __ Mov(x0, data_address);
+  __ Mov(x1, 0x1234);
+  __ Add(x2, x0, 16);
+  __ Bind(&store);
+  __ Str(w1, MemOperand(x0, 4));
+  __ Bind(&load);
+  __ Ld1(v0.V2D(), MemOperand(x2));
+
+  END();
+  if (CAN_RUN()) {
+    RUN();
+    simulator.SetMemoryTrace(NULL);
+    writer.Flush();
+    VIXL_CHECK(!writer.HasError());
+    rewind(stream);
+
+    // The trace also includes any accesses made by the test harness.
+    MemoryTraceReader reader(stream, 3);
+    VIXL_CHECK(reader.IsValid());
+    MemoryTraceRecord record;
+    uint64_t count = 0;
+    int data_accesses = 0;
+    while (reader.Next(&record)) {
+      count++;
+      if ((record.address < data_address) ||
+          (record.address >= (data_address + sizeof(data)))) {
+        continue;
+      }
+      if (data_accesses++ == 0) {
+        VIXL_CHECK(record.pc == masm.GetLabelAddress<uint64_t>(&store));
+        VIXL_CHECK(record.address == data_address + 4);
+        VIXL_CHECK(record.size == 4);
+        VIXL_CHECK(record.IsWrite() && !record.IsVector());
+      } else {
+        VIXL_CHECK(record.pc == masm.GetLabelAddress<uint64_t>(&load));
+        VIXL_CHECK(record.address == data_address + 16);
+        VIXL_CHECK(record.size == 16);
+        VIXL_CHECK(!record.IsWrite() && record.IsVector());
+        VIXL_CHECK(!record.IsGather());
+      }
+    }
+    VIXL_CHECK(data_accesses == 2);
+    VIXL_CHECK(count == writer.GetRecordCount());
+    ASSERT_EQUAL_128(4, 3, q0);
+  }
+  fclose(stream);
+}
+
 #ifdef VIXL_NEGATIVE_TESTING
 TEST(sim_stack_limit_guard_read) {
   SimStack builder;
@@ -13684,6 +14438,28 @@ TEST(sim_stack_base_guard_write) {
     MUST_FAIL_WITH_MESSAGE(RUN(), "Attempt to write to stack guard region");
   }
 }
+
+TEST(sim_guest_memory_unmapped_read) {
+  SETUP();
+  SimGuestMemory guest;
+  guest.MapRegion(reinterpret_cast<uintptr_t>(&core),
+                  &core,
+                  sizeof(core),
+                  SimGuestMemory::kReadWrite);
+  simulator.SetGuestMemory(&guest);
+  START();
+
+  // The host address of a local variable is not mapped in the guest.
+  uint64_t local = 0;
+  __ Mov(x0, reinterpret_cast<uintptr_t>(&local));
+  __ Ldr(x1, MemOperand(x0));
+
+  END();
+  if (CAN_RUN()) {
+    MUST_FAIL_WITH_MESSAGE(RUN(),
+                           "Attempt to read from inaccessible guest memory");
+  }
+}
 #endif
 #endif
 
@@ -190,7 +190,8 @@ namespace aarch64 {
   DISASSEMBLE();                         \
   VIXL_ASSERT(QUERIED_CAN_RUN());        \
   VIXL_ASSERT(CAN_RUN());                \
-  simulator.RunFrom(masm.GetBuffer()->GetStartAddress<Instruction*>())
+  simulator.RunFrom(                     \
+      masm.GetBuffer()->GetExecutableStartAddress<Instruction*>())
 
 #else  // ifdef VIXL_INCLUDE_SIMULATOR_AARCH64.
 #define SETUP()        \
@@ -243,13 +244,13 @@ namespace aarch64 {
   masm.FinalizeCode()
 
 // Execute the generated code from the memory area.
-#define RUN()                                               \
-  DISASSEMBLE();                                            \
-  VIXL_ASSERT(QUERIED_CAN_RUN());                           \
-  VIXL_ASSERT(CAN_RUN());                                   \
-  masm.GetBuffer()->SetExecutable();                        \
-  ExecuteMemory(masm.GetBuffer()->GetStartAddress<byte*>(), \
-                masm.GetSizeOfCodeGenerated());             \
+#define RUN()                                                         \
+  DISASSEMBLE();                                                      \
+  VIXL_ASSERT(QUERIED_CAN_RUN());                                     \
+  VIXL_ASSERT(CAN_RUN());                                             \
+  masm.GetBuffer()->SetExecutable();                                  \
+  ExecuteMemory(masm.GetBuffer()->GetExecutableStartAddress<byte*>(), \
+                masm.GetSizeOfCodeGenerated());                       \
   masm.GetBuffer()->SetWritable()
 
 // This just provides compatibility with VIXL_INCLUDE_SIMULATOR_AARCH64 builds.
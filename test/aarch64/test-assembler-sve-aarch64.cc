@@ -574,6 +574,83 @@ TEST_SVE(sve_bitwise_unpredicate_logical) {
   }
 }
 
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+// The simulator has specialised implementations of some lane-wise operations
+// for common vector lengths, so check every lane at those lengths, as well as
+// some others.
+static void SVELanewiseArithmeticHelper(unsigned vl, int lane_size_in_bits) {
+  SETUP_WITH_FEATURES(CPUFeatures::kSVE);
+  simulator.SetVectorLengthInBits(vl);
+  START();
+
+  ZRegister zn = z0.WithLaneSize(lane_size_in_bits);
+  ZRegister zm = z1.WithLaneSize(lane_size_in_bits);
+  ZRegister add = z2.WithLaneSize(lane_size_in_bits);
+  ZRegister sub = z3.WithLaneSize(lane_size_in_bits);
+  ZRegister add_m = z8.WithLaneSize(lane_size_in_bits);
+  ZRegister sub_m = z9.WithLaneSize(lane_size_in_bits);
+  ZRegister subr_m = z10.WithLaneSize(lane_size_in_bits);
+  PRegisterWithLaneSize pg = p1.WithLaneSize(lane_size_in_bits);
+
+  __ Index(zn, -16, 5);
+  __ Index(zm, 7, -3);
+
+  __ Add(add, zn, zm);
+  __ Sub(sub, zn, zm);
+  __ And(z4.VnD(), z0.VnD(), z1.VnD());
+  __ Bic(z5.VnD(), z0.VnD(), z1.VnD());
+  __ Eor(z6.VnD(), z0.VnD(), z1.VnD());
+  __ Orr(z7.VnD(), z0.VnD(), z1.VnD());
+
+  // Predicated forms, including the reversed subtraction.
+  __ Ptrue(pg, SVE_VL7);
+  __ Mov(add_m, zn);
+  __ Add(add_m, pg.Merging(), add_m, zm);
+  __ Mov(sub_m, zn);
+  __ Sub(sub_m, pg.Merging(), sub_m, zm);
+  __ Mov(subr_m, zm);
+  __ Sub(subr_m, pg.Merging(), zn, subr_m);
+  END();
+
+  if (CAN_RUN()) {
+    RUN();
+
+    int lane_count = vl / lane_size_in_bits;
+    uint64_t mask = GetUintMask(lane_size_in_bits);
+    for (int i = 0; i < lane_count; i++) {
+      uint64_t n = (-16 + 5 * i) & mask;
+      uint64_t m = (7 - 3 * i) & mask;
+      uint64_t sum = (n + m) & mask;
+      uint64_t diff = (n - m) & mask;
+      // SVE_VL7 makes the predicate all-false if there are fewer than seven
+      // lanes.
+      bool active = (lane_count >= 7) && (i < 7);
+      ASSERT_EQUAL_SVE_LANE(sum, add, i);
+      ASSERT_EQUAL_SVE_LANE(diff, sub, i);
+      ASSERT_EQUAL_SVE_LANE(n & m, z4.WithLaneSize(lane_size_in_bits), i);
+      ASSERT_EQUAL_SVE_LANE(n & ~m & mask,
+                            z5.WithLaneSize(lane_size_in_bits),
+                            i);
+      ASSERT_EQUAL_SVE_LANE(n ^ m, z6.WithLaneSize(lane_size_in_bits), i);
+      ASSERT_EQUAL_SVE_LANE(n | m, z7.WithLaneSize(lane_size_in_bits), i);
+      ASSERT_EQUAL_SVE_LANE(active ? sum : n, add_m, i);
+      ASSERT_EQUAL_SVE_LANE(active ? diff : n, sub_m, i);
+      ASSERT_EQUAL_SVE_LANE(active ? diff : m, subr_m, i);
+    }
+  }
+}
+
+TEST(sve_lanewise_arithmetic_vl) {
+  unsigned vls[] = {128, 256, 384, 512, 2048};
+  for (unsigned vl : vls) {
+    SVELanewiseArithmeticHelper(vl, kBRegSize);
+    SVELanewiseArithmeticHelper(vl, kHRegSize);
+    SVELanewiseArithmeticHelper(vl, kSRegSize);
+    SVELanewiseArithmeticHelper(vl, kDRegSize);
+  }
+}
+#endif
+
 TEST_SVE(sve_last_r) {
   SVE_SETUP_WITH_FEATURES(CPUFeatures::kSVE, CPUFeatures::kNEON);
   START();
@@ -10176,6 +10253,135 @@ TEST_SVE(sve_ld1sh_32bit_vector_plus_immediate) {
                                         true);
 }
 
+TEST_SVE(sve_gather_scatter_patterns) {
+  SVE_SETUP_WITH_FEATURES(CPUFeatures::kSVE);
+  START();
+
+  // Offsets are in words, so each buffer needs room for
+  // `3 + (5 * (kZRegMaxSizeInBytes / kSRegSizeInBytes))` words.
+  const int kBufferWords = 512;
+  alignas(64) uint32_t data[kBufferWords];
+  alignas(64) uint32_t strided[kBufferWords];
+  alignas(64) uint32_t duplicated[kBufferWords];
+  for (int i = 0; i < kBufferWords; i++) {
+    data[i] = UINT32_C(0x01010101) * i;
+    strided[i] = 0;
+    duplicated[i] = 0;
+  }
+
+  __ Mov(x0, reinterpret_cast<uintptr_t>(data));
+  __ Mov(x1, reinterpret_cast<uintptr_t>(strided));
+  __ Mov(x2, reinterpret_cast<uintptr_t>(duplicated));
+  __ Ptrue(p0.VnS());
+  // Every second S-sized lane.
+  __ Ptrue(p1.VnD());
+
+  __ Index(z1.VnS(), 0, 1);
+  __ Index(z2.VnS(), 3, 5);
+  __ Lsr(z3.VnS(), z1.VnS(), 2);
+  __ Index(z4.VnS(), 100, 1);
+
+  // Contiguous.
+  __ Ld1w(z10.VnS(), p0.Zeroing(), SVEMemOperand(x0, z1.VnS(), UXTW, 2));
+  __ Ld1w(z11.VnS(), p1.Zeroing(), SVEMemOperand(x0, z1.VnS(), UXTW, 2));
+  // Constant stride.
+  __ Ld1w(z12.VnS(), p0.Zeroing(), SVEMemOperand(x0, z2.VnS(), UXTW, 2));
+  __ St1w(z4.VnS(), p0, SVEMemOperand(x1, z2.VnS(), UXTW, 2));
+  // Four lanes for each address.
+  __ Ld1w(z13.VnS(), p0.Zeroing(), SVEMemOperand(x0, z3.VnS(), UXTW, 2));
+  __ St1w(z4.VnS(), p0, SVEMemOperand(x2, z3.VnS(), UXTW, 2));
+
+  END();
+
+  if (CAN_RUN()) {
+    RUN();
+
+    int lane_count = core.GetSVELaneCount(kSRegSize);
+    for (int i = 0; i < lane_count; i++) {
+      ASSERT_EQUAL_SVE_LANE(data[i], z10.VnS(), i);
+      ASSERT_EQUAL_SVE_LANE(((i % 2) == 0) ? data[i] : 0, z11.VnS(), i);
+      ASSERT_EQUAL_SVE_LANE(data[3 + (5 * i)], z12.VnS(), i);
+      ASSERT_EQUAL_SVE_LANE(data[i / 4], z13.VnS(), i);
+    }
+
+    for (int i = 0; i < kBufferWords; i++) {
+      int lane = (i - 3) / 5;
+      bool stored = (i >= 3) && (((i - 3) % 5) == 0) && (lane < lane_count);
+      VIXL_CHECK(strided[i] ==
+                 (stored ? static_cast<uint32_t>(100 + lane) : 0));
+      // The highest-numbered lane wins.
+      lane = (4 * i) + 3;
+      stored = lane < lane_count;
+      VIXL_CHECK(duplicated[i] ==
+                 (stored ? static_cast<uint32_t>(100 + lane) : 0));
+    }
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+    const SimGatherScatterStats& stats = simulator.GetGatherScatterStats();
+    VIXL_CHECK(stats.gathers == 4);
+    VIXL_CHECK(stats.scatters == 2);
+    VIXL_CHECK(stats.elements ==
+               static_cast<uint64_t>((5 * lane_count) + (lane_count / 2)));
+    VIXL_CHECK(stats.contiguous == 2);
+    VIXL_CHECK(stats.strided == 2);
+    VIXL_CHECK(stats.coalesced_elements ==
+               static_cast<uint64_t>(2 * (lane_count - (lane_count / 4))));
+
+    // Lines touched by the contiguous, strided and duplicated accesses.
+    int contiguous_lines = ((lane_count * 4) + 63) / 64;
+    int sparse_contiguous_lines = ((lane_count * 4) + 59) / 64;
+    int strided_lines = ((4 * (3 + (5 * (lane_count - 1)))) / 64) + 1;
+    int duplicated_lines = (lane_count + 63) / 64;
+    int lines = contiguous_lines + sparse_contiguous_lines +
+                (2 * strided_lines) + (2 * duplicated_lines);
+    VIXL_CHECK(stats.unique_lines == static_cast<uint64_t>(lines));
+#endif
+  }
+}
+
+TEST_SVE(sve_ld1_inactive_elements_not_accessed) {
+  SVE_SETUP_WITH_FEATURES(CPUFeatures::kSVE);
+
+  const int kMaxLanes = kZRegMaxSizeInBytes / kSRegSizeInBytes;
+  uint32_t data[kMaxLanes];
+  for (int i = 0; i < kMaxLanes; i++) data[i] = 100 + i;
+  uintptr_t data_address = reinterpret_cast<uintptr_t>(data);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  // Lane 1 is inactive, so it must not be read, even though it lies between
+  // active lanes.
+  SimWatchpoints* watchpoints = simulator.GetWatchpoints();
+  watchpoints->Add(data_address + 4, 4, SimWatchpoints::kRead);
+#endif
+  START();
+
+  __ Mov(x0, data_address);
+  __ Ptrue(p0.VnS());
+  __ Index(z1.VnS(), 0, 1);
+  __ Cmpne(p1.VnS(), p0.Zeroing(), z1.VnS(), 1);
+
+  __ Ld1w(z10.VnS(), p1.Zeroing(), SVEMemOperand(x0));
+  // A gather of adjacent elements uses the same code.
+  __ Ld1w(z11.VnS(), p1.Zeroing(), SVEMemOperand(x0, z1.VnS(), UXTW, 2));
+
+  END();
+
+  if (CAN_RUN()) {
+    RUN();
+
+    int lane_count = core.GetSVELaneCount(kSRegSize);
+    for (int i = 0; i < lane_count; i++) {
+      uint32_t expected = (i == 1) ? 0 : data[i];
+      ASSERT_EQUAL_SVE_LANE(expected, z10.VnS(), i);
+      ASSERT_EQUAL_SVE_LANE(expected, z11.VnS(), i);
+    }
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+    VIXL_CHECK(watchpoints->GetHitCount() == 0);
+#endif
+  }
+}
+
 TEST_SVE(sve_ld1_scalar_plus_vector_32_scaled_offset) {
   auto ld1_32_scaled_offset_helper =
       std::bind(&GatherLoadScalarPlusVectorHelper<Extend>,
@@ -14453,6 +14659,70 @@ TEST_SVE(sve_brkn) {
   BrknHelper(config, pd, pg_3, pn_3, pm, kAllFalse);
 }
 
+// Check predicate operations whose interesting lanes are near the end of the
+// vector, beyond the first 64 bits of the predicate.
+TEST_SVE(sve_predicate_high_lanes) {
+  SVE_SETUP_WITH_FEATURES(CPUFeatures::kSVE);
+  START();
+
+  int vl_in_bytes = config->sve_vl_in_bits() / kBitsPerByte;
+  int break_lane = vl_in_bytes - 3;
+
+  __ Ptrue(p0.VnB());
+  __ Index(z0.VnB(), 0, 1);
+  __ Dup(z1.VnB(), break_lane);
+  __ Cmpeq(p1.VnB(), p0.Zeroing(), z0.VnB(), z1.VnB());
+
+  __ Brka(p2.VnB(), p0.Zeroing(), p1.VnB());
+  __ Brkb(p3.VnB(), p0.Zeroing(), p1.VnB());
+  __ Cntp(x0, p0, p2.VnB());
+  __ Cntp(x1, p0, p3.VnH());
+  __ Lastb(x2, p3, z0.VnB());
+  __ Sel(z2.VnB(), p3, z0.VnB(), z1.VnB());
+  __ Sel(z3.VnD(), p3, z0.VnD(), z1.VnD());
+
+  // The whole vector, with a limit that is only reached by the last lane.
+  __ Mov(x10, 42);
+  __ Mov(x11, 42 + (vl_in_bytes / kSRegSizeInBytes) - 1);
+  __ Whilelo(p4.VnS(), x10, x11);
+  __ Cntp(x3, p0, p4.VnS());
+  __ Mrs(x4, NZCV);
+  __ Whilels(p5.VnS(), x10, x11);
+  __ Cntp(x5, p0, p5.VnS());
+  __ Mrs(x6, NZCV);
+
+  END();
+
+  if (CAN_RUN()) {
+    RUN();
+
+    ASSERT_EQUAL_64(break_lane + 1, x0);
+    ASSERT_EQUAL_64((break_lane + 1) / 2, x1);
+    ASSERT_EQUAL_64(break_lane - 1, x2);
+    for (int i = 0; i < vl_in_bytes; i++) {
+      uint64_t expected = (i < break_lane) ? i : break_lane;
+      ASSERT_EQUAL_SVE_LANE(expected, z2.VnB(), i);
+    }
+    // The first D lanes are governed by the first byte of each lane.
+    int d_lanes = vl_in_bytes / static_cast<int>(kDRegSizeInBytes);
+    for (int i = 0; i < d_lanes; i++) {
+      bool active = (i * static_cast<int>(kDRegSizeInBytes)) < break_lane;
+      ASSERT_EQUAL_SVE_LANE(active ? 0x0706050403020100 +
+                                         (i * 0x0808080808080808)
+                                   : break_lane * 0x0101010101010101,
+                            z3.VnD(),
+                            i);
+    }
+
+    int s_lanes = vl_in_bytes / kSRegSizeInBytes;
+    ASSERT_EQUAL_64(s_lanes - 1, x3);
+    // N: first active, Z: none active, C: last not active.
+    ASSERT_EQUAL_64(SVEFirstFlag | SVENotLastFlag, x4);
+    ASSERT_EQUAL_64(s_lanes, x5);
+    ASSERT_EQUAL_64(SVEFirstFlag, x6);
+  }
+}
+
 TEST_SVE(sve_trn) {
   SVE_SETUP_WITH_FEATURES(CPUFeatures::kSVE);
   START();
@@ -0,0 +1,194 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+#include <vector>
+
+#include "test-runner.h"
+
+#include "aarch64/cpu-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_CACHE_MAINTENANCE_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+// Record the maintenance operations instead of performing them, so that the
+// batching logic can be tested on any host.
+class MockCacheMaintenanceBackend : public CacheMaintenanceBackend {
+ public:
+  MockCacheMaintenanceBackend(unsigned dcache_line_size,
+                              unsigned icache_line_size)
+      : dcache_line_size_(dcache_line_size),
+        icache_line_size_(icache_line_size) {}
+
+  virtual unsigned GetDCacheLineSize() const VIXL_OVERRIDE {
+    return dcache_line_size_;
+  }
+  virtual unsigned GetICacheLineSize() const VIXL_OVERRIDE {
+    return icache_line_size_;
+  }
+
+  virtual void CleanDCacheLines(uintptr_t start, uintptr_t end) VIXL_OVERRIDE {
+    VIXL_CHECK(IsAligned(start, dcache_line_size_));
+    for (uintptr_t line = start; line < end; line += dcache_line_size_) {
+      dcache_lines_.push_back(line);
+    }
+    operations_ += 'D';
+  }
+
+  virtual void InvalidateICacheLines(uintptr_t start,
+                                     uintptr_t end) VIXL_OVERRIDE {
+    VIXL_CHECK(IsAligned(start, icache_line_size_));
+    for (uintptr_t line = start; line < end; line += icache_line_size_) {
+      icache_lines_.push_back(line);
+    }
+    operations_ += 'I';
+  }
+
+  virtual void DataSynchronisationBarrier() VIXL_OVERRIDE {
+    operations_ += 'B';
+  }
+
+  virtual void InstructionSynchronisationBarrier() VIXL_OVERRIDE {
+    operations_ += 'S';
+  }
+
+  std::vector<uintptr_t> dcache_lines_;
+  std::vector<uintptr_t> icache_lines_;
+  // 'D': D cache clean, 'I': I cache invalidate, 'B': dsb, 'S': isb.
+  std::string operations_;
+
+ private:
+  unsigned dcache_line_size_;
+  unsigned icache_line_size_;
+};
+
+
+static const void* Address(uintptr_t address) {
+  return reinterpret_cast<const void*>(address);
+}
+
+
+TEST(merge) {
+  MockCacheMaintenanceBackend backend(64, 32);
+  CacheMaintenanceBatch batch(&backend);
+
+  // Overlapping, adjacent and unsorted ranges, all within one D cache line.
+  batch.Add(Address(0x1038), 8);
+  batch.Add(Address(0x1000), 4);
+  batch.Add(Address(0x1004), 12);
+  VIXL_CHECK(!batch.IsEmpty());
+  batch.Flush();
+  VIXL_CHECK(batch.IsEmpty());
+
+  VIXL_CHECK(backend.operations_ == "DBIBS");
+  VIXL_CHECK(backend.dcache_lines_.size() == 1);
+  VIXL_CHECK(backend.dcache_lines_[0] == 0x1000);
+  VIXL_CHECK(backend.icache_lines_.size() == 2);
+  VIXL_CHECK(backend.icache_lines_[0] == 0x1000);
+  VIXL_CHECK(backend.icache_lines_[1] == 0x1020);
+
+  const CacheMaintenanceStats& stats = batch.GetStats();
+  VIXL_CHECK(stats.ranges_added == 3);
+  VIXL_CHECK(stats.ranges_flushed == 1);
+  VIXL_CHECK(stats.dcache_lines_flushed == 1);
+  VIXL_CHECK(stats.icache_lines_flushed == 2);
+  VIXL_CHECK(stats.epochs == 1);
+  VIXL_CHECK(stats.GetCallsSaved() == 2);
+}
+
+
+TEST(shared_lines) {
+  MockCacheMaintenanceBackend backend(64, 16);
+  CacheMaintenanceBatch batch(&backend);
+
+  // These ranges do not touch at I cache line granularity, but share a D cache
+  // line, which should only be cleaned once.
+  batch.Add(Address(0x2000), 4);
+  batch.Add(Address(0x2030), 4);
+  batch.Add(Address(0x2080), 0x80);
+  batch.Flush();
+
+  VIXL_CHECK(backend.operations_ == "DDBIIIBS");
+  VIXL_CHECK(backend.dcache_lines_.size() == 3);
+  VIXL_CHECK(backend.dcache_lines_[0] == 0x2000);
+  VIXL_CHECK(backend.dcache_lines_[1] == 0x2080);
+  VIXL_CHECK(backend.dcache_lines_[2] == 0x20c0);
+  VIXL_CHECK(backend.icache_lines_.size() == 10);
+
+  const CacheMaintenanceStats& stats = batch.GetStats();
+  VIXL_CHECK(stats.ranges_flushed == 3);
+  VIXL_CHECK(stats.dcache_lines_flushed == 3);
+  VIXL_CHECK(stats.icache_lines_flushed == 10);
+}
+
+
+TEST(epochs) {
+  MockCacheMaintenanceBackend backend(64, 64);
+  CacheMaintenanceBatch batch(&backend);
+
+  // Flushing an empty batch does nothing.
+  batch.Flush();
+  batch.Add(Address(0x3000), 0);
+  batch.Flush();
+  VIXL_CHECK(backend.operations_.empty());
+
+  // Each epoch has its own barrier sequence.
+  for (int i = 0; i < 10; i++) {
+    batch.Add(Address(0x3000 + (i * 0x100)), 4);
+  }
+  batch.Flush();
+  batch.Add(Address(0x3000), 4);
+  batch.Flush();
+  VIXL_CHECK(backend.operations_ ==
+             "DDDDDDDDDDBIIIIIIIIIIBS"
+             "DBIBS");
+
+  const CacheMaintenanceStats& stats = batch.GetStats();
+  VIXL_CHECK(stats.ranges_added == 12);
+  VIXL_CHECK(stats.epochs == 2);
+  VIXL_CHECK(stats.GetCallsSaved() == 10);
+
+  batch.ResetStats();
+  VIXL_CHECK(batch.GetStats().ranges_added == 0);
+}
+
+
+TEST(host) {
+  // On AArch64 hosts this performs real cache maintenance, and elsewhere it
+  // does nothing, but it should always be safe.
+  CPU::SetUp();
+  std::vector<uint32_t> code(1024, 0xd503201f);  // nop
+  CacheMaintenanceBatch batch;
+  batch.Add(&code[0], 64 * sizeof(code[0]));
+  batch.Add(&code[512], 256 * sizeof(code[0]));
+  batch.Flush();
+  VIXL_CHECK(batch.GetStats().epochs == 1);
+}
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,343 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "test-runner.h"
+#include "test-utils-aarch64.h"
+
+#include "aarch64/code-cache-aarch64.h"
+#include "aarch64/code-space-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_CODE_CACHE_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+#ifdef VIXL_CODE_BUFFER_MMAP
+
+// Create an empty temporary file, and return its name.
+static std::string CreateTemporaryFile() {
+  char name[] = "/tmp/vixl-test-code-cache-XXXXXX";
+  int fd = mkstemp(name);
+  VIXL_CHECK(fd >= 0);
+  close(fd);
+  return name;
+}
+
+
+static int64_t value_at_write = 1;
+static int64_t value_at_load = 2;
+
+
+TEST(round_trip) {
+  std::string path = CreateTemporaryFile();
+
+  {
+    CodeCacheWriter writer;
+    writer.AddImport("value", &value_at_write);
+
+    // Two stubs, generated together.
+    MacroAssembler add_masm;
+    Label add_one, add_two;
+    add_masm.Bind(&add_one);
+    add_masm.Add(x0, x0, 1);
+    add_masm.Ret();
+    add_masm.Bind(&add_two);
+    add_masm.Add(x0, x0, 2);
+    add_masm.Ret();
+    add_masm.FinalizeCode();
+    size_t add = writer.AddEntry("add", &add_masm);
+    writer.AddSymbol(add, "add_one", &add_one);
+    writer.AddSymbol(add, "add_two", &add_two);
+
+    // A stub that refers to something outside of itself.
+    MacroAssembler load_masm;
+    load_masm.SetRecordRelocations(true);
+    Label address;
+    {
+      ExactAssemblyScope scope(&load_masm, 6 * kInstructionSize);
+      // Load the word at `address`.
+      load_masm.ldr(x1, 4);
+      load_masm.ldr(x1, MemOperand(x1));
+      load_masm.add(x0, x0, x1);
+      load_masm.ret();
+      load_masm.bind(&address);
+      load_masm.dc64(0);
+    }
+    load_masm.RecordRelocation(Relocation::kAbsolute64,
+                               address.GetLocation(),
+                               reinterpret_cast<uintptr_t>(&value_at_write));
+    load_masm.FinalizeCode();
+    writer.AddEntry("load", &load_masm);
+
+    VIXL_CHECK(writer.WriteToFile(path.c_str()));
+  }
+
+  CodeSpace code_space;
+  CodeCache cache(&code_space, CPUFeatures::All());
+  VIXL_CHECK(cache.Open(path.c_str()));
+  VIXL_CHECK(cache.GetEntryCount() == 2);
+  VIXL_CHECK(cache.HasEntry("add"));
+  VIXL_CHECK(cache.HasEntry("load"));
+  VIXL_CHECK(!cache.HasEntry("missing"));
+  VIXL_CHECK(cache.GetEntry("missing") == NULL);
+
+  // Nothing is loaded until it is used.
+  VIXL_CHECK(cache.GetLoadedEntryCount() == 0);
+
+  byte* add = static_cast<byte*>(cache.GetEntry("add"));
+  VIXL_CHECK(add != NULL);
+  VIXL_CHECK(cache.GetSymbol("add", "add_one") == add);
+  VIXL_CHECK(cache.GetSymbol("add", "add_two") == add + 2 * kInstructionSize);
+  VIXL_CHECK(cache.GetSymbol("add", "add_three") == NULL);
+  VIXL_CHECK(cache.GetLoadedEntryCount() == 1);
+
+  // Entries that use undefined imports are rejected.
+  VIXL_CHECK(cache.GetEntry("load") == NULL);
+  cache.DefineImport("value", &value_at_load);
+  void* load = cache.GetEntry("load");
+  VIXL_CHECK(load != NULL);
+  VIXL_CHECK(cache.GetLoadedEntryCount() == 2);
+
+  // Loading an entry again returns the same code.
+  VIXL_CHECK(cache.GetEntry("load") == load);
+  VIXL_CHECK(cache.GetLoadedEntryCount() == 2);
+
+  code_space.Publish();
+  int64_t result;
+  if (RunCode(cache.GetSymbol("add", "add_two"), 40, &result)) {
+    VIXL_CHECK(result == 42);
+    VIXL_CHECK(RunCode(load, 40, &result));
+    VIXL_CHECK(result == 40 + value_at_load);
+  }
+
+  // Loaded code outlives the mapping of the file.
+  cache.Close();
+  VIXL_CHECK(!cache.IsOpen());
+  if (RunCode(add, 41, &result)) {
+    VIXL_CHECK(result == 42);
+  }
+
+  remove(path.c_str());
+}
+
+
+struct ImportedValues {
+  int64_t first;
+  int64_t second;
+  int64_t third;
+};
+
+static ImportedValues values_at_write = {1, 2, 3};
+static ImportedValues values_at_load = {10, 20, 30};
+
+
+TEST(import_offset) {
+  std::string path = CreateTemporaryFile();
+
+  {
+    CodeCacheWriter writer;
+    writer.AddImport("values", &values_at_write);
+
+    // A stub that refers to a field of an imported structure.
+    MacroAssembler masm;
+    masm.SetRecordRelocations(true);
+    Label address;
+    {
+      ExactAssemblyScope scope(&masm, 6 * kInstructionSize);
+      masm.ldr(x1, 4);
+      masm.ldr(x1, MemOperand(x1));
+      masm.add(x0, x0, x1);
+      masm.ret();
+      masm.bind(&address);
+      masm.dc64(0);
+    }
+    masm.RecordRelocation(Relocation::kAbsolute64,
+                          address.GetLocation(),
+                          reinterpret_cast<uintptr_t>(&values_at_write.third));
+    masm.FinalizeCode();
+    writer.AddEntry("load_third", &masm);
+
+    VIXL_CHECK(writer.WriteToFile(path.c_str()));
+  }
+
+  CodeSpace code_space;
+  CodeCache cache(&code_space, CPUFeatures::All());
+  VIXL_CHECK(cache.Open(path.c_str()));
+  cache.DefineImport("values", &values_at_load);
+  byte* load = static_cast<byte*>(cache.GetEntry("load_third"));
+  VIXL_CHECK(load != NULL);
+
+  // The literal holds the address of the same field of the new structure.
+  uint64_t literal;
+  memcpy(&literal, load + 4 * kInstructionSize, sizeof(literal));
+  VIXL_CHECK(literal == reinterpret_cast<uintptr_t>(&values_at_load.third));
+
+  code_space.Publish();
+  int64_t result;
+  if (RunCode(load, 40, &result)) {
+    VIXL_CHECK(result == 40 + values_at_load.third);
+  }
+
+  remove(path.c_str());
+}
+
+
+TEST(cpu_features) {
+  std::string path = CreateTemporaryFile();
+
+  {
+    CodeCacheWriter writer;
+    MacroAssembler masm;
+    masm.Ret();
+    masm.FinalizeCode();
+    writer.AddEntry("base", &masm, CPUFeatures());
+    writer.AddEntry("neon", &masm, CPUFeatures(CPUFeatures::kNEON));
+    writer.AddEntry("sve",
+                    &masm,
+                    CPUFeatures(CPUFeatures::kNEON, CPUFeatures::kSVE));
+    VIXL_CHECK(writer.WriteToFile(path.c_str()));
+  }
+
+  CodeSpace code_space;
+  CodeCache cache(&code_space,
+                  CPUFeatures(CPUFeatures::kFP, CPUFeatures::kNEON));
+  VIXL_CHECK(cache.Open(path.c_str()));
+  VIXL_CHECK(cache.IsEntryCompatible("base"));
+  VIXL_CHECK(cache.IsEntryCompatible("neon"));
+  VIXL_CHECK(!cache.IsEntryCompatible("sve"));
+  VIXL_CHECK(!cache.IsEntryCompatible("missing"));
+  VIXL_CHECK(cache.GetEntry("base") != NULL);
+  VIXL_CHECK(cache.GetEntry("neon") != NULL);
+  VIXL_CHECK(cache.GetEntry("sve") == NULL);
+  VIXL_CHECK(cache.GetLoadedEntryCount() == 2);
+
+  CodeCache sve_cache(&code_space, CPUFeatures::All());
+  VIXL_CHECK(sve_cache.Open(path.c_str()));
+  VIXL_CHECK(sve_cache.GetEntry("sve") != NULL);
+  code_space.Publish();
+
+  remove(path.c_str());
+}
+
+
+TEST(invalid_file) {
+  std::string path = CreateTemporaryFile();
+  CodeSpace code_space;
+  CodeCache cache(&code_space);
+
+  // Empty.
+  VIXL_CHECK(!cache.Open(path.c_str()));
+  VIXL_CHECK(!cache.IsOpen());
+
+  CodeCacheWriter writer;
+  MacroAssembler masm;
+  masm.Ret();
+  masm.FinalizeCode();
+  writer.AddEntry("ret", &masm);
+  std::vector<byte> data;
+  writer.Serialise(&data);
+
+  // Truncated, or with a bad header.
+  for (int i = 0; i < 2; i++) {
+    std::vector<byte> corrupt = data;
+    if (i == 0) {
+      corrupt.pop_back();
+    } else {
+      corrupt[0] ^= 1;
+    }
+    FILE* file = fopen(path.c_str(), "wb");
+    VIXL_CHECK(file != NULL);
+    VIXL_CHECK(fwrite(corrupt.data(), 1, corrupt.size(), file) ==
+               corrupt.size());
+    VIXL_CHECK(fclose(file) == 0);
+    VIXL_CHECK(!cache.Open(path.c_str()));
+    VIXL_CHECK(!cache.IsOpen());
+  }
+
+  VIXL_CHECK(!cache.Open("/nonexistent/vixl-code-cache"));
+  VIXL_CHECK(!cache.IsOpen());
+
+  remove(path.c_str());
+}
+
+
+#ifdef VIXL_HAS_MACROASSEMBLER_RUNTIME_CALL_SUPPORT
+static int64_t runtime_call_add_ten(int64_t value) { return value + 10; }
+static int64_t runtime_call_double(int64_t value) { return value * 2; }
+
+
+TEST(runtime_call) {
+  std::string path = CreateTemporaryFile();
+
+  {
+    CodeCacheWriter writer;
+    // These have the same signature, so they share a simulator wrapper.
+    writer.AddRuntimeCallImport("add_ten", runtime_call_add_ten);
+    writer.AddRuntimeCallImport("double", runtime_call_double);
+
+    MacroAssembler masm;
+    masm.SetRecordRelocations(true);
+    masm.Push(lr, xzr);
+    masm.CallRuntime(runtime_call_double);
+    masm.Pop(xzr, lr);
+    masm.TailCallRuntime(runtime_call_add_ten);
+    masm.FinalizeCode();
+    writer.AddEntry("call", &masm);
+
+    VIXL_CHECK(writer.WriteToFile(path.c_str()));
+  }
+
+  CodeSpace code_space;
+  CodeCache cache(&code_space, CPUFeatures::All());
+  VIXL_CHECK(cache.Open(path.c_str()));
+
+  // Every runtime call import has to be defined.
+  VIXL_CHECK(cache.GetEntry("call") == NULL);
+  cache.DefineRuntimeCallImport("add_ten", runtime_call_add_ten);
+  VIXL_CHECK(cache.GetEntry("call") == NULL);
+  cache.DefineRuntimeCallImport("double", runtime_call_double);
+  void* call = cache.GetEntry("call");
+  VIXL_CHECK(call != NULL);
+
+  code_space.Publish();
+  int64_t result;
+  if (RunCode(call, 16, &result)) {
+    VIXL_CHECK(result == 42);
+  }
+
+  remove(path.c_str());
+}
+#endif  // VIXL_HAS_MACROASSEMBLER_RUNTIME_CALL_SUPPORT
+
+#endif  // VIXL_CODE_BUFFER_MMAP
+
+}  // namespace aarch64
+}  // namespace vixl
@@ -0,0 +1,128 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "test-runner.h"
+
+#include "aarch64/code-space-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+#include "aarch64/simulator-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_CODE_SPACE_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+#ifdef VIXL_CODE_BUFFER_MMAP
+
+TEST(allocation_size) {
+  VIXL_CHECK(CodeSpace::GetAllocationSize(1) == 16);
+  VIXL_CHECK(CodeSpace::GetAllocationSize(16) == 16);
+  VIXL_CHECK(CodeSpace::GetAllocationSize(17) == 32);
+  VIXL_CHECK(CodeSpace::GetAllocationSize(100) == 128);
+  VIXL_CHECK(CodeSpace::GetAllocationSize(kPageSize) == kPageSize);
+  VIXL_CHECK(CodeSpace::GetAllocationSize(kPageSize + 1) == 2 * kPageSize);
+}
+
+
+TEST(packing_and_reuse) {
+  CodeSpace code_space;
+  uint32_t code[64];
+  for (unsigned i = 0; i < ArrayLength(code); i++) code[i] = i;
+
+  // Many small stubs share a single region, and never straddle a page.
+  const int kStubCount = 1000;
+  std::vector<uintptr_t> stubs;
+  for (int i = 0; i < kStubCount; i++) {
+    size_t size = (1 + (i % ArrayLength(code))) * sizeof(code[0]);
+    uintptr_t stub = reinterpret_cast<uintptr_t>(code_space.Commit(code, size));
+    size_t allocation_size = CodeSpace::GetAllocationSize(size);
+    VIXL_CHECK(IsAligned(stub, CodeSpace::kMinAllocationSize));
+    VIXL_CHECK(AlignDown(stub, kPageSize) ==
+               AlignDown(stub + allocation_size - 1, kPageSize));
+    stubs.push_back(stub);
+  }
+  VIXL_CHECK(code_space.GetRegionCount() == 1);
+  VIXL_CHECK(code_space.HasUnpublishedCode());
+  code_space.Publish();
+  VIXL_CHECK(!code_space.HasUnpublishedCode());
+
+  for (int i = 0; i < kStubCount; i++) {
+    size_t size = (1 + (i % ArrayLength(code))) * sizeof(code[0]);
+    VIXL_CHECK(memcmp(reinterpret_cast<void*>(stubs[i]), code, size) == 0);
+  }
+
+  // Freed stubs are reused by allocations of the same size class.
+  size_t allocated = code_space.GetAllocatedBytes();
+  code_space.Free(reinterpret_cast<void*>(stubs[5]));
+  VIXL_CHECK(code_space.GetAllocatedBytes() ==
+             (allocated - CodeSpace::GetAllocationSize(6 * sizeof(code[0]))));
+  void* reused = code_space.Commit(code, 5 * sizeof(code[0]));
+  VIXL_CHECK(reinterpret_cast<uintptr_t>(reused) == stubs[5]);
+  VIXL_CHECK(code_space.GetAllocatedBytes() == allocated);
+  code_space.Publish();
+  VIXL_CHECK(memcmp(reused, code, 5 * sizeof(code[0])) == 0);
+
+  // Large allocations start on a page boundary.
+  std::vector<uint8_t> large(3 * kPageSize, 0x42);
+  void* large_code = code_space.Commit(large.data(), large.size());
+  VIXL_CHECK(IsAligned(reinterpret_cast<uintptr_t>(large_code), kPageSize));
+  code_space.Publish();
+  VIXL_CHECK(memcmp(large_code, large.data(), large.size()) == 0);
+}
+
+
+TEST(commit_masm) {
+  CodeSpace code_space;
+
+  MacroAssembler masm;
+  masm.Add(x0, x0, 42);
+  masm.Ret();
+  masm.FinalizeCode();
+
+  void* code = code_space.Commit(&masm);
+  code_space.Publish();
+  VIXL_CHECK(memcmp(code,
+                    masm.GetBuffer()->GetStartAddress<const void*>(),
+                    masm.GetSizeOfCodeGenerated()) == 0);
+
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.WriteXRegister(0, 1);
+  simulator.RunFrom(reinterpret_cast<Instruction*>(code));
+  VIXL_CHECK(simulator.ReadXRegister(0) == 43);
+#elif defined(__aarch64__)
+  int64_t (*function)(int64_t);
+  VIXL_STATIC_ASSERT(sizeof(code) == sizeof(function));
+  memcpy(&function, &code, sizeof(function));
+  VIXL_CHECK(function(1) == 43);
+#endif
+}
+
+#endif  // VIXL_CODE_BUFFER_MMAP
+
+}  // namespace aarch64
+}  // namespace vixl
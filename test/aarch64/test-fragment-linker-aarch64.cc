@@ -0,0 +1,235 @@
+// Copyright 2026, VIXL authors
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of ARM Limited nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "test-runner.h"
+#include "test-utils-aarch64.h"
+
+#include "aarch64/code-space-aarch64.h"
+#include "aarch64/fragment-linker-aarch64.h"
+#include "aarch64/macro-assembler-aarch64.h"
+
+#define TEST(name) TEST_(AARCH64_FRAGMENT_LINKER_##name)
+
+namespace vixl {
+namespace aarch64 {
+
+#ifdef VIXL_CODE_BUFFER_MMAP
+
+// Link `linker` into a new CodeSpace allocation, and return its address.
+static byte* LinkAndCommit(FragmentLinker* linker, CodeSpace* code_space) {
+  CodeBuffer buffer;
+  linker->Link(&buffer);
+  buffer.SetClean();
+  void* code = code_space->Commit(buffer.GetStartAddress<const void*>(),
+                                  buffer.GetSizeInBytes(),
+                                  linker->GetRelocations());
+  code_space->Publish();
+  return static_cast<byte*>(code);
+}
+
+
+static int64_t value = 4;
+
+
+TEST(link) {
+  // These fragments are independent, so they could be generated in parallel.
+  CodeFragment callees;
+  {
+    MacroAssembler* masm = callees.GetMacroAssembler();
+    callees.Bind("add_one");
+    masm->Add(x0, x0, 1);
+    masm->Ret();
+    callees.Bind("add_two");
+    masm->Ldr(x2, 2);
+    masm->Add(x0, x0, x2);
+    masm->Ret();
+    callees.FinalizeCode();
+  }
+
+  CodeFragment caller;
+  {
+    MacroAssembler* masm = caller.GetMacroAssembler();
+    caller.Bind("entry");
+    masm->Mov(x1, lr);
+    caller.Bl("add_one");
+    caller.Bl("add_one");
+    masm->Mov(lr, x1);
+    caller.B("add_two");
+    caller.FinalizeCode();
+  }
+
+  CodeFragment load;
+  {
+    MacroAssembler* masm = load.GetMacroAssembler();
+    load.Bind("load");
+    {
+      ExactAssemblyScope scope(masm, 6 * kInstructionSize);
+      masm->ldr(x1, 4);
+      masm->ldr(x1, MemOperand(x1));
+      masm->add(x0, x0, x1);
+      masm->ret();
+      masm->dc64(0);
+    }
+    masm->RecordRelocation(Relocation::kAbsolute64,
+                           4 * kInstructionSize,
+                           reinterpret_cast<uintptr_t>(&value));
+    load.FinalizeCode();
+  }
+
+  FragmentLinker linker;
+  linker.AddFragment(&callees);
+  linker.AddFragment(&caller);
+  linker.AddFragment(&load);
+
+  CodeSpace code_space;
+  byte* code = LinkAndCommit(&linker, &code_space);
+
+  VIXL_CHECK(linker.GetVeneerCount() == 0);
+  VIXL_CHECK(linker.GetSymbolOffset("add_one") == 0);
+  VIXL_CHECK(linker.GetSymbolOffset("add_two") == 2 * kInstructionSize);
+  VIXL_CHECK(IsAligned(linker.GetSymbolOffset("entry"),
+                       FragmentLinker::kFragmentAlignment));
+  VIXL_CHECK(!linker.HasSymbol("missing"));
+
+  // Relocations are moved with their fragments.
+  VIXL_CHECK(linker.GetRelocations().size() == 1);
+  VIXL_CHECK(linker.GetRelocations()[0].offset ==
+             linker.GetSymbolOffset("load") + 4 * kInstructionSize);
+
+  int64_t result;
+  if (RunCode(code + linker.GetSymbolOffset("entry"), 38, &result)) {
+    VIXL_CHECK(result == 42);
+    VIXL_CHECK(RunCode(code + linker.GetSymbolOffset("load"), 38, &result));
+    VIXL_CHECK(result == 38 + value);
+  }
+}
+
+
+TEST(veneers) {
+  CodeFragment test;
+  {
+    MacroAssembler* masm = test.GetMacroAssembler();
+    test.Bind("entry");
+    test.Tbz(x0, 0, "even");
+    masm->Mov(x0, 1);
+    masm->Ret();
+    test.FinalizeCode();
+  }
+
+  // Put "even" out of range of the `tbz`, but not of a `b`.
+  CodeFragment filler;
+  {
+    MacroAssembler* masm = filler.GetMacroAssembler();
+    filler.Bind("filler");
+    const int kFillerSize = 64 * KBytes;
+    for (int i = 0; i < kFillerSize; i += kInstructionSize) {
+      masm->Nop();
+    }
+    filler.B("entry");
+    filler.FinalizeCode();
+  }
+
+  CodeFragment even;
+  {
+    MacroAssembler* masm = even.GetMacroAssembler();
+    even.Bind("even");
+    masm->Mov(x0, 2);
+    masm->Ret();
+    even.FinalizeCode();
+  }
+
+  FragmentLinker linker;
+  linker.AddFragment(&test);
+  linker.AddFragment(&filler);
+  linker.AddFragment(&even);
+
+  CodeSpace code_space;
+  byte* code = LinkAndCommit(&linker, &code_space);
+
+  // Only the `tbz` needs a veneer.
+  VIXL_CHECK(linker.GetVeneerCount() == 1);
+  VIXL_CHECK(linker.GetSymbolOffset("filler") >=
+             static_cast<ptrdiff_t>(3 * kInstructionSize +
+                                    FragmentLinker::kVeneerSize));
+
+  int64_t result;
+  if (RunCode(code + linker.GetSymbolOffset("entry"), 4, &result)) {
+    VIXL_CHECK(result == 2);
+    VIXL_CHECK(RunCode(code + linker.GetSymbolOffset("entry"), 3, &result));
+    VIXL_CHECK(result == 1);
+  }
+}
+
+
+TEST(veneers_before_fragment) {
+  // The `tbz` cannot reach the end of its own fragment, so its veneer has to
+  // go before the fragment.
+  CodeFragment test;
+  {
+    MacroAssembler* masm = test.GetMacroAssembler();
+    test.Bind("entry");
+    test.Tbz(x0, 0, "even");
+    const int kFillerSize = 48 * KBytes;
+    for (int i = 0; i < kFillerSize; i += kInstructionSize) {
+      masm->Nop();
+    }
+    masm->Mov(x0, 1);
+    masm->Ret();
+    test.FinalizeCode();
+  }
+
+  CodeFragment even;
+  {
+    MacroAssembler* masm = even.GetMacroAssembler();
+    even.Bind("even");
+    masm->Mov(x0, 2);
+    masm->Ret();
+    even.FinalizeCode();
+  }
+
+  FragmentLinker linker;
+  linker.AddFragment(&test);
+  linker.AddFragment(&even);
+
+  CodeSpace code_space;
+  byte* code = LinkAndCommit(&linker, &code_space);
+
+  VIXL_CHECK(linker.GetVeneerCount() == 1);
+  VIXL_CHECK(linker.GetSymbolOffset("entry") >=
+             static_cast<ptrdiff_t>(FragmentLinker::kVeneerSize));
+
+  int64_t result;
+  if (RunCode(code + linker.GetSymbolOffset("entry"), 4, &result)) {
+    VIXL_CHECK(result == 2);
+    VIXL_CHECK(RunCode(code + linker.GetSymbolOffset("entry"), 3, &result));
+    VIXL_CHECK(result == 1);
+  }
+}
+
+#endif  // VIXL_CODE_BUFFER_MMAP
+
+}  // namespace aarch64
+}  // namespace vixl
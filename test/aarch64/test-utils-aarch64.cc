@@ -778,5 +778,26 @@ bool CanRun(const CPUFeatures& required, bool* queried_can_run) {
 #endif
 }
 
+
+bool RunCode(void* code, int64_t input, int64_t* result) {
+#ifdef VIXL_INCLUDE_SIMULATOR_AARCH64
+  Decoder decoder;
+  Simulator simulator(&decoder);
+  simulator.WriteXRegister(0, input);
+  simulator.RunFrom(reinterpret_cast<Instruction*>(code));
+  *result = simulator.ReadXRegister(0);
+  return true;
+#elif defined(__aarch64__)
+  int64_t (*function)(int64_t);
+  VIXL_STATIC_ASSERT(sizeof(code) == sizeof(function));
+  memcpy(&function, &code, sizeof(function));
+  *result = function(input);
+  return true;
+#else
+  USE(code, input, result);
+  return false;
+#endif
+}
+
 }  // namespace aarch64
 }  // namespace vixl
@@ -579,6 +579,11 @@ class StrictNaNPropagationMacroAssembler : public MacroAssembler {
 // queried_can_run is NULL, CanRun must not be called more than once per test.
 bool CanRun(const CPUFeatures& required, bool* queried_can_run = NULL);
 
+// Run code that has been published for execution, taking and returning a value
+// in x0, with the simulator or natively. Returns false if code cannot be run
+// on this host.
+bool RunCode(void* code, int64_t input, int64_t* result);
+
 // PushCalleeSavedRegisters(), PopCalleeSavedRegisters() and Dump() use NEON, so
 // we need to enable it in the infrastructure code for each test.
 static const CPUFeatures kInfrastructureCPUFeatures(CPUFeatures::kNEON);
@@ -163,4 +163,70 @@ TEST(emit) {
                     expected_size) == 0);
 }
 
+TEST(dual_mapping) {
+  if (!CodeBuffer::IsDualMappingSupported()) return;
+
+  CodeBuffer buffer;
+  buffer.EnableDualMapping();
+  VIXL_CHECK(buffer.IsDualMapped());
+  VIXL_CHECK(buffer.GetCapacity() == CodeBuffer::kDefaultCapacity);
+  VIXL_CHECK(buffer.GetExecutableStartAddress<uintptr_t>() !=
+             buffer.GetStartAddress<uintptr_t>());
+
+  // Writes through the writable view are visible through the executable view,
+  // without any change of permissions.
+  const char* test_string = "dual-mapped";
+  buffer.EmitString(test_string);
+  buffer.SetExecutable();
+  VIXL_CHECK(strcmp(buffer.GetExecutableStartAddress<const char*>(),
+                    test_string) == 0);
+  buffer.UpdateData(0, "D", 1);
+  VIXL_CHECK(strcmp(buffer.GetExecutableStartAddress<const char*>(),
+                    "Dual-mapped") == 0);
+  buffer.SetWritable();
+
+  // Growing the buffer keeps both views, and their contents.
+  size_t size = buffer.GetSizeInBytes();
+  buffer.EnsureSpaceFor(4 * CodeBuffer::kDefaultCapacity);
+  VIXL_CHECK(buffer.GetCapacity() > 4 * CodeBuffer::kDefaultCapacity);
+  VIXL_CHECK(buffer.IsDualMapped());
+  VIXL_CHECK(buffer.GetSizeInBytes() == size);
+  buffer.EmitZeroedBytes(4 * CodeBuffer::kDefaultCapacity);
+  VIXL_CHECK(memcmp(buffer.GetExecutableStartAddress<const void*>(),
+                    buffer.GetStartAddress<const void*>(),
+                    buffer.GetSizeInBytes()) == 0);
+
+  buffer.SetClean();
+}
+
+#ifdef VIXL_CODE_BUFFER_MMAP
+TEST(reserved_growth) {
+  const size_t reserved_size = 1 * MBytes;
+  CodeBuffer buffer;
+  buffer.ReserveAddressSpace(reserved_size);
+  VIXL_CHECK(buffer.GetReservedSize() == reserved_size);
+  VIXL_CHECK(buffer.GetCapacity() == CodeBuffer::kDefaultCapacity);
+
+  uintptr_t start = buffer.GetStartAddress<uintptr_t>();
+  uint64_t value = 0x0123456789abcdef;
+  buffer.Emit64(value);
+
+  // The buffer grows in place, and is limited by the reservation.
+  while (buffer.GetCapacity() < reserved_size) {
+    buffer.EmitZeroedBytes(static_cast<int>(buffer.GetRemainingBytes() + 1));
+    VIXL_CHECK(buffer.GetStartAddress<uintptr_t>() == start);
+    VIXL_CHECK(buffer.GetCapacity() <= reserved_size);
+  }
+  VIXL_CHECK(memcmp(buffer.GetStartAddress<const void*>(),
+                    &value,
+                    sizeof(value)) == 0);
+
+  // The whole reservation is usable.
+  buffer.EmitZeroedBytes(static_cast<int>(buffer.GetRemainingBytes()));
+  VIXL_CHECK(buffer.GetSizeInBytes() == reserved_size);
+
+  buffer.SetClean();
+}
+#endif
+
 }  // namespace vixl
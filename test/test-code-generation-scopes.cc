@@ -769,4 +769,88 @@ TEST(ExactAssemblyScope_scope_with_pools_64) {
 #endif  // VIXL_INCLUDE_TARGET_AARCH64
 
 
+#ifdef VIXL_INCLUDE_TARGET_AARCH64
+static void GenerateBulkSequence_64(aarch64::MacroAssembler* masm, int count) {
+  for (int i = 0; i < count; i++) {
+    masm->Add(aarch64::x0, aarch64::x1, i);
+    masm->Mov(aarch64::x2, 0x1234567800000000 + i);
+    masm->Str(aarch64::x0, aarch64::MemOperand(aarch64::sp, i * 8));
+  }
+}
+
+
+TEST(BulkEmissionScope_64) {
+  const int kCount = 16;
+  const size_t kSize =
+      aarch64::BulkEmissionScope::GetSizeForMacroInstructions(3 * kCount);
+
+  aarch64::MacroAssembler masm;
+  __ Ldr(aarch64::x10, 0x1234567890abcdef);
+  ASSERT_LITERAL_POOL_SIZE_64(8);
+
+  {
+    aarch64::BulkEmissionScope scope(&masm, kSize);
+    VIXL_CHECK(masm.IsInBulkEmission());
+    VIXL_CHECK(masm.ArePoolsBlocked());
+    GenerateBulkSequence_64(&masm, kCount / 2);
+    {
+      // Bulk emission scopes can be nested.
+      aarch64::BulkEmissionScope inner(&masm, kSize / 2);
+      GenerateBulkSequence_64(&masm, kCount / 2);
+    }
+    VIXL_CHECK(masm.IsInBulkEmission());
+  }
+  VIXL_CHECK(!masm.IsInBulkEmission());
+  VIXL_CHECK(!masm.ArePoolsBlocked());
+  ASSERT_LITERAL_POOL_SIZE_64(8);
+  masm.FinalizeCode();
+
+  // The code is the same as it would be without the scope.
+  aarch64::MacroAssembler reference;
+  reference.Ldr(aarch64::x10, 0x1234567890abcdef);
+  GenerateBulkSequence_64(&reference, kCount / 2);
+  GenerateBulkSequence_64(&reference, kCount / 2);
+  reference.FinalizeCode();
+
+  VIXL_CHECK(masm.GetSizeOfCodeGenerated() ==
+             reference.GetSizeOfCodeGenerated());
+  VIXL_CHECK(memcmp(masm.GetBuffer()->GetStartAddress<const void*>(),
+                    reference.GetBuffer()->GetStartAddress<const void*>(),
+                    masm.GetSizeOfCodeGenerated()) == 0);
+}
+
+
+TEST(BulkEmissionScope_open_close_64) {
+  const size_t kSize =
+      aarch64::BulkEmissionScope::GetSizeForMacroInstructions(1);
+
+  aarch64::MacroAssembler masm;
+
+  {
+    aarch64::BulkEmissionScope scope;
+    VIXL_CHECK(!masm.IsInBulkEmission());
+    scope.Open(&masm, kSize);
+    VIXL_CHECK(masm.IsInBulkEmission());
+    VIXL_CHECK(masm.ArePoolsBlocked());
+    __ Add(aarch64::x0, aarch64::x1, 42);
+    scope.Close();
+    VIXL_CHECK(!masm.IsInBulkEmission());
+    VIXL_CHECK(!masm.ArePoolsBlocked());
+  }
+
+  // The emission check scopes used by macro instructions can still be opened
+  // through the generic interface.
+  {
+    MacroAssemblerInterface* interface = &masm;
+    aarch64::SingleEmissionCheckScope single(interface);
+    VIXL_CHECK(masm.ArePoolsBlocked());
+    aarch64::MacroEmissionCheckScope macro(interface);
+  }
+  VIXL_CHECK(!masm.ArePoolsBlocked());
+
+  masm.FinalizeCode();
+}
+#endif  // VIXL_INCLUDE_TARGET_AARCH64
+
+
 }  // namespace vixl